@@ -0,0 +1,85 @@
+"""
+Times a full static layout of a random graph with 1 up to N layout threads
+and prints the speedup over one thread. Run with "make bench".
+
+usage: layoutbench.py [mycelia binary] [nodes] [edges] [max threads]
+"""
+
+import multiprocessing
+import random
+import socket
+import subprocess
+import sys
+import time
+import xmlrpclib
+
+binary = len(sys.argv) > 1 and sys.argv[1] or './mycelia'
+nodes = len(sys.argv) > 2 and int(sys.argv[2]) or 50000
+edges = len(sys.argv) > 3 and int(sys.argv[3]) or 150000
+max_threads = len(sys.argv) > 4 and int(sys.argv[4]) or multiprocessing.cpu_count()
+filename = '/tmp/layoutbench.chaco'
+
+
+def write_graph():
+    random.seed(0)
+    neighbors = [[] for node in xrange(nodes)]
+
+    for edge in xrange(edges):
+        neighbors[random.randrange(nodes)].append(random.randrange(nodes) + 1)
+
+    out = open(filename, 'w')
+    out.write('%i %i\n' % (nodes, edges))
+
+    for targets in neighbors:
+        out.write(' '.join(map(str, targets)) + '\n')
+
+    out.close()
+
+
+def connect(process):
+    server = xmlrpclib.Server('http://localhost:9876')
+
+    while process.poll() is None:
+        try:
+            server.system.listMethods()
+            return server
+        except socket.error:
+            time.sleep(1)
+
+    return None
+
+
+def time_layout(server, threads):
+    server.set_layout_threads(threads)
+    start = time.time()
+    server.layout(False)
+
+    while not server.layout_is_stopped():
+        time.sleep(0.1)
+
+    return time.time() - start
+
+
+write_graph()
+process = subprocess.Popen([binary])
+server = connect(process)
+
+if server is None:
+    print 'mycelia exited before its server came up'
+    sys.exit(1)
+
+server.open_file(filename)
+server.stop_layout()
+server.set_layout_type(0)
+
+threads = 1
+base = None
+print '%i nodes, %i edges' % (nodes, edges)
+
+while threads <= max_threads:
+    seconds = time_layout(server, threads)
+    base = base or seconds
+    print '%2i threads: %6.1fs  %.2fx' % (threads, seconds, base / seconds)
+    threads = threads < max_threads and min(threads * 2, max_threads) or threads + 1
+
+process.terminate()
@@ -0,0 +1,100 @@
+"""
+Lays out each graph with the static layout's exact repulsion, then with
+Barnes-Hut at a few opening angles, and prints the time and the quality of
+each: the mean edge length over the mean distance between two nodes, lower
+is better. Every run starts from the same PivotMDS placement. Run with
+"make repulsionbench".
+
+usage: repulsionbench.py [mycelia binary] [graph files...]
+"""
+
+import glob
+import math
+import random
+import socket
+import subprocess
+import sys
+import time
+import xmlrpclib
+
+binary = len(sys.argv) > 1 and sys.argv[1] or './mycelia'
+files = sys.argv[2:] or sorted(glob.glob('data/*.xml'))
+angles = [0.5, 0.8, 1.2]
+pairs = 20000
+
+# see REPULSION_EXACT and REPULSION_BARNES_HUT in frlayout.hpp
+EXACT = 0
+BARNES_HUT = 1
+
+
+def connect(process):
+    server = xmlrpclib.Server('http://localhost:9876')
+
+    while process.poll() is None:
+        try:
+            server.system.listMethods()
+            return server
+        except socket.error:
+            time.sleep(1)
+
+    return None
+
+
+def time_layout(server):
+    start = time.time()
+    server.layout(False)
+
+    while not server.layout_is_stopped():
+        time.sleep(0.1)
+
+    return time.time() - start
+
+
+def quality(server):
+    positions = {}
+
+    for node, x, y, z in server.get_node_positions():
+        positions[node] = (x, y, z)
+
+    edges = [(source, target) for edge, source, target in server.get_edges() if source != target]
+    nodes = positions.keys()
+
+    if not edges or len(nodes) < 2:
+        return 0
+
+    edge = sum(distance(positions[s], positions[t]) for s, t in edges) / len(edges)
+
+    random.seed(0)
+    pair = sum(distance(positions[random.choice(nodes)], positions[random.choice(nodes)])
+               for i in xrange(pairs)) / pairs
+
+    return edge / pair
+
+
+def distance(p, q):
+    return math.sqrt(sum((a - b) ** 2 for a, b in zip(p, q)))
+
+
+process = subprocess.Popen([binary])
+server = connect(process)
+
+if server is None:
+    print 'mycelia exited before its server came up'
+    sys.exit(1)
+
+server.set_layout_type(0)
+print '%-20s %-16s %8s %8s' % ('graph', 'repulsion', 'time', 'quality')
+
+for filename in files:
+    server.open_file(filename)
+    server.stop_layout()
+
+    runs = [('exact', EXACT, 0.0)] + [('barnes-hut %.1f' % angle, BARNES_HUT, angle) for angle in angles]
+
+    for name, repulsion, angle in runs:
+        server.set_repulsion(repulsion)
+        server.set_opening_angle(angle)
+        seconds = time_layout(server)
+        print '%-20s %-16s %7.2fs %8.4f' % (filename.split('/')[-1], name, seconds, quality(server))
+
+process.terminate()
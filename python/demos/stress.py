@@ -0,0 +1,86 @@
+"""
+Loads a large random graph into mycelia and lets it render and lay out for a
+while, failing if mycelia goes away. Run with "make stress".
+
+usage: stress.py [mycelia binary] [nodes] [edges] [seconds]
+"""
+
+import os
+import random
+import socket
+import subprocess
+import sys
+import time
+import xmlrpclib
+
+binary = len(sys.argv) > 1 and sys.argv[1] or './mycelia'
+nodes = len(sys.argv) > 2 and int(sys.argv[2]) or 1000000
+edges = len(sys.argv) > 3 and int(sys.argv[3]) or 5000000
+seconds = len(sys.argv) > 4 and int(sys.argv[4]) or 60
+filename = '/tmp/stress.chaco'
+
+
+def write_graph():
+    print 'writing %i nodes, %i edges to %s' % (nodes, edges, filename)
+    random.seed(0)
+    neighbors = [[] for node in xrange(nodes)]
+
+    for edge in xrange(edges):
+        neighbors[random.randrange(nodes)].append(random.randrange(nodes) + 1)
+
+    out = open(filename, 'w')
+    out.write('%i %i\n' % (nodes, edges))
+
+    for targets in neighbors:
+        out.write(' '.join(map(str, targets)) + '\n')
+
+    out.close()
+
+
+def connect(process):
+    server = xmlrpclib.Server('http://localhost:9876')
+
+    while process.poll() is None:
+        try:
+            server.system.listMethods()
+            return server
+        except socket.error:
+            time.sleep(1)
+
+    return None
+
+
+def fail(message, process):
+    print 'stress failed: %s' % message
+
+    if process.poll() is None:
+        process.terminate()
+
+    sys.exit(1)
+
+
+if not os.path.exists(filename):
+    write_graph()
+
+process = subprocess.Popen([binary])
+server = connect(process)
+
+if server is None:
+    fail('mycelia exited before its server came up', process)
+
+start = time.time()
+server.open_file(filename)
+print 'loaded in %.1fs' % (time.time() - start)
+
+server.layout(True)
+server.center()
+
+while time.time() - start < seconds:
+    if process.poll() is not None:
+        fail('mycelia exited with %i' % process.returncode, process)
+
+    server.draw()
+    time.sleep(1)
+
+print 'stress passed'
+process.terminate()
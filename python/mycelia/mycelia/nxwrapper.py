@@ -23,7 +23,7 @@ class MyceliaServer:
 
         self.node_types = ['shape', 'image', 'imageScale']
         self.texture_modes = ['align', 'rotate']
-        self.layout_types = {'static':0, 'dynamic':1}
+        self.layout_types = {'static':0, 'dynamic':1, 'multilevel':2, 'rough':3, 'spectral':4, 'incremental':5}
 
         self.graph_attrs = [
             'texture_mode',
@@ -70,7 +70,10 @@ class MyceliaServer:
         for attr in self.custom_node_attrs:
             val = attrs.get(attr, None)
             if val is not None:
-                self.server.set_node_attribute(myid, attr, str(val))
+                # numbers go through as they are, so their column is numeric
+                if type(val) not in (int, float):
+                    val = str(val)
+                self.server.set_node_attribute(myid, attr, val)
 
     def _parse_edge_attrs(self, myid, attrs):
         label = attrs.get(self.label, None)
@@ -120,7 +123,7 @@ class MyceliaServer:
 
     def set_layout_type(self, layout):
         if layout not in self.layout_types:
-            raise Exception("Layout should be 'static' or 'dynamic'.")
+            raise Exception("Layout should be 'static', 'dynamic', 'multilevel', 'rough', 'spectral' or 'incremental'.")
         else:
             self.server.set_layout_type(self.layout_types[layout])
 
@@ -4,14 +4,21 @@ warnings.filterwarnings('ignore')
 import numpy
 import pylab
 
-data = numpy.loadtxt('/tmp/input.txt')
+# the node count, then one "source target" line per nonzero entry
+f = open('/tmp/input.txt')
+n = int(f.readline())
+data = numpy.loadtxt(f, dtype=int).reshape(-1, 2)
+f.close()
 
 pylab.figure(figsize=(6, 6))
 pylab.xlabel('Destination Node')
 pylab.ylabel('Source Node')
 pylab.title('Adjacency Matrix')
-pylab.pcolor(pylab.flipud(data), cmap=pylab.get_cmap('binary'))
-pylab.xlim(0, len(data))
-pylab.ylim(0, len(data))
+
+# one square per entry, source 0 at the top like the dense plot was
+size = max(0.5, 400.0 / max(n, 1))
+pylab.plot(data[:, 1] + 0.5, n - data[:, 0] - 0.5, 'ks', markersize=size, markeredgewidth=0)
+pylab.xlim(0, n)
+pylab.ylim(0, n)
 
 pylab.savefig('/tmp/output.png')
@@ -0,0 +1,132 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <adjacencypool.hpp>
+
+using namespace std;
+
+AdjacencyPool::AdjacencyPool()
+    : freeCount(0)
+{
+}
+
+// returns the offset of a new span
+const int AdjacencyPool::allocate(int sizeClass)
+{
+    int capacity = getCapacity(sizeClass);
+
+    if(sizeClass < (int)freeSpans.size() && !freeSpans[sizeClass].empty())
+    {
+        int offset = freeSpans[sizeClass].back();
+        freeSpans[sizeClass].pop_back();
+        freeCount -= capacity;
+        return offset;
+    }
+
+    int offset = entries.size();
+
+    for(int i = 0; i < capacity; i++)
+    {
+        entries.push_back(Incidence());
+    }
+
+    return offset;
+}
+
+void AdjacencyPool::free(int offset, int sizeClass)
+{
+    if(sizeClass >= (int)freeSpans.size())
+    {
+        freeSpans.resize(sizeClass + 1);
+    }
+
+    freeSpans[sizeClass].push_back(offset);
+    freeCount += getCapacity(sizeClass);
+}
+
+// copies a list from another pool into the smallest span that holds it
+const AdjacencyList AdjacencyPool::append(const AdjacencyPool& pool, const AdjacencyList& list)
+{
+    AdjacencyList copy;
+
+    while(getCapacity(copy.sizeClass) < (int)list.size) copy.sizeClass++;
+    copy.offset = allocate(copy.sizeClass);
+    copy.size = list.size;
+
+    for(int index = 0; index < (int)list.size; index++)
+    {
+        entries.edit(copy.offset + index) = pool.get(list, index);
+    }
+
+    return copy;
+}
+
+// returns the index of the new entry within the list
+const int AdjacencyPool::push_back(AdjacencyList& list, const Incidence& i)
+{
+    if((int)list.size == getCapacity(list.sizeClass))
+    {
+        int offset = allocate(list.sizeClass + 1);
+
+        for(int index = 0; index < (int)list.size; index++)
+        {
+            entries.edit(offset + index) = entries[list.offset + index];
+        }
+
+        if(list.sizeClass > 0)
+        {
+            free(list.offset, list.sizeClass);
+        }
+
+        list.offset = offset;
+        list.sizeClass++;
+    }
+
+    entries.edit(list.offset + list.size) = i;
+    return list.size++;
+}
+
+// gives the list's span back to the pool, leaving it empty
+void AdjacencyPool::release(AdjacencyList& list)
+{
+    if(list.sizeClass > 0)
+    {
+        free(list.offset, list.sizeClass);
+    }
+
+    list = AdjacencyList();
+}
+
+void AdjacencyPool::clear()
+{
+    entries.clear();
+    freeSpans.clear();
+    freeCount = 0;
+}
+
+// bytes held by the pool, free spans included
+const long AdjacencyPool::getBytes() const
+{
+    return (long)entries.size() * sizeof(Incidence);
+}
+
+// true once a quarter of the pool sits in free spans, see Graph::compactIncidences()
+const bool AdjacencyPool::isFragmented() const
+{
+    return freeCount > 1024 && 4 * freeCount > entries.size();
+}
@@ -0,0 +1,112 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ADJACENCYPOOL_HPP
+#define __ADJACENCYPOOL_HPP
+
+#include <cowvector.hpp>
+#include <vector>
+
+// An entry in a node's incidence list: an edge and the node at its other end.
+class Incidence
+{
+public:
+    int node;
+    int edge;
+
+    Incidence()
+      : node(-1),
+        edge(-1)
+    {
+    }
+
+    Incidence(int node, int edge)
+      : node(node),
+        edge(edge)
+    {
+    }
+};
+
+// A span of an AdjacencyPool holding one incidence list.
+class AdjacencyList
+{
+public:
+    int offset;
+    unsigned int size : 24;
+    unsigned int sizeClass : 8; // capacity is AdjacencyPool::getCapacity(sizeClass)
+
+    AdjacencyList()
+      : offset(0),
+        size(0),
+        sizeClass(0)
+    {
+    }
+};
+
+/*
+ * Every incidence list of a graph, packed into one array. Each list owns a
+ * contiguous span from one of a few size classes (1, 2, 3, 4, 6, 8, 12...);
+ * a full list moves to the next class up and its old span goes on the free
+ * list for its class, so parallel edges sit side by side and nothing is
+ * allocated per edge. The array is a CowVector, so snapshots share it chunk
+ * by chunk.
+ */
+class AdjacencyPool
+{
+private:
+    CowVector<Incidence> entries;
+    std::vector<std::vector<int> > freeSpans; // offsets, by size class
+    int freeCount;
+
+    const int allocate(int);
+    void free(int, int);
+
+public:
+    AdjacencyPool();
+
+    static const int getCapacity(int sizeClass)
+    {
+        if(sizeClass == 0) return 0;
+        return (sizeClass & 1) ? (3 << (sizeClass / 2)) / 2 : 1 << (sizeClass / 2);
+    }
+
+    const Incidence& get(const AdjacencyList& list, int index) const
+    {
+        return entries[list.offset + index];
+    }
+
+    void set(AdjacencyList& list, int index, const Incidence& i)
+    {
+        entries.edit(list.offset + index) = i;
+    }
+
+    void pop_back(AdjacencyList& list)
+    {
+        list.size--;
+    }
+
+    const AdjacencyList append(const AdjacencyPool&, const AdjacencyList&);
+    const int push_back(AdjacencyList&, const Incidence&);
+    void release(AdjacencyList&);
+    void clear();
+
+    const long getBytes() const;
+    const bool isFragmented() const;
+};
+
+#endif
@@ -0,0 +1,554 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <attributestore.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+
+using namespace std;
+
+const int AttributeColumn::MISSING = INT_MIN;
+
+static const float missingFloat = numeric_limits<float>::quiet_NaN();
+
+/*
+ * AttributeColumn
+ */
+AttributeColumn::AttributeColumn(const string& name, Type type, int indexes)
+    : name(name),
+      type(type),
+      indexes(indexes),
+      strings(new vector<string>()),
+      codes(new Codes())
+{
+}
+
+const bool AttributeColumn::parseInt(const string& s, int& value)
+{
+    if(s.empty()) return false;
+
+    char* end;
+    errno = 0;
+    long l = strtol(s.c_str(), &end, 10);
+
+    if(*end != '\0' || errno == ERANGE || l <= INT_MIN || l > INT_MAX)
+    {
+        return false;
+    }
+
+    value = l;
+    return true;
+}
+
+const bool AttributeColumn::parseFloat(const string& s, double& value)
+{
+    if(s.empty()) return false;
+
+    char* end;
+    value = strtod(s.c_str(), &end);
+
+    // nan and inf are left to string columns
+    return *end == '\0' && value == value && fabs(value) <= numeric_limits<float>::max();
+}
+
+static string format(double value)
+{
+    ostringstream out;
+    out << value;
+    return out.str();
+}
+
+// returns the code for s, adding it to the dictionary if it's new
+const int AttributeColumn::encode(const string& s)
+{
+    Codes::iterator i = codes->find(s);
+
+    if(i != codes->end())
+    {
+        return i->second;
+    }
+
+    if(!strings.unique() || !codes.unique())
+    {
+        strings.reset(new vector<string>(*strings));
+        codes.reset(new Codes(*codes));
+    }
+
+    int code = strings->size();
+    strings->push_back(s);
+    (*codes)[s] = code;
+    return code;
+}
+
+// only for INT and FLOAT columns
+const double AttributeColumn::getNumber(int slot) const
+{
+    return type == INT ? ints[slot] : floats[slot];
+}
+
+const AttributeColumn::HashIndex& AttributeColumn::getHashIndex() const
+{
+    if(!hashIndex)
+    {
+        HashIndex* index = new HashIndex();
+
+        for(int slot = 0; slot < ints.size(); slot++)
+        {
+            if(ints[slot] != MISSING) (*index)[ints[slot]].push_back(slot);
+        }
+
+        hashIndex.reset(index);
+    }
+
+    return *hashIndex;
+}
+
+const vector<pair<double, int> >& AttributeColumn::getSortedIndex() const
+{
+    if(!sortedIndex)
+    {
+        vector<pair<double, int> >* index = new vector<pair<double, int> >();
+        index->reserve(size());
+
+        for(int slot = 0; slot < size(); slot++)
+        {
+            if(has(slot)) index->push_back(pair<double, int>(getNumber(slot), slot));
+        }
+
+        std::sort(index->begin(), index->end());
+        sortedIndex.reset(index);
+    }
+
+    return *sortedIndex;
+}
+
+// adds the value of slot to the indexes that have been built
+void AttributeColumn::index(int slot)
+{
+    if(!has(slot)) return;
+
+    if(hashIndex && type != FLOAT)
+    {
+        if(!hashIndex.unique()) hashIndex.reset(new HashIndex(*hashIndex));
+
+        (*hashIndex)[ints[slot]].push_back(slot);
+    }
+
+    if(sortedIndex && type != STRING)
+    {
+        if(!sortedIndex.unique()) sortedIndex.reset(new vector<pair<double, int> >(*sortedIndex));
+
+        pair<double, int> entry(getNumber(slot), slot);
+        sortedIndex->insert(std::lower_bound(sortedIndex->begin(), sortedIndex->end(), entry), entry);
+    }
+}
+
+// removes the value of slot from the indexes that have been built, before it
+// changes
+void AttributeColumn::unindex(int slot)
+{
+    if(!has(slot)) return;
+
+    if(hashIndex && type != FLOAT)
+    {
+        if(!hashIndex.unique()) hashIndex.reset(new HashIndex(*hashIndex));
+
+        HashIndex::iterator entry = hashIndex->find(ints[slot]);
+
+        if(entry != hashIndex->end())
+        {
+            vector<int>& slots = entry->second;
+            slots.erase(std::find(slots.begin(), slots.end(), slot));
+            if(slots.empty()) hashIndex->erase(entry);
+        }
+    }
+
+    if(sortedIndex && type != STRING)
+    {
+        if(!sortedIndex.unique()) sortedIndex.reset(new vector<pair<double, int> >(*sortedIndex));
+
+        pair<double, int> entry(getNumber(slot), slot);
+        vector<pair<double, int> >::iterator i = std::lower_bound(sortedIndex->begin(), sortedIndex->end(), entry);
+        if(i != sortedIndex->end() && *i == entry) sortedIndex->erase(i);
+    }
+}
+
+void AttributeColumn::invalidate()
+{
+    hashIndex.reset();
+    sortedIndex.reset();
+}
+
+// converts every value to a wider type
+void AttributeColumn::promote(Type to)
+{
+    if(to <= type) return;
+
+    if(to == FLOAT)
+    {
+        for(int slot = 0; slot < ints.size(); slot++)
+        {
+            floats.push_back(ints[slot] == MISSING ? missingFloat : ints[slot]);
+        }
+
+        ints.clear();
+    }
+    else
+    {
+        CowVector<int> encoded;
+
+        for(int slot = 0; slot < size(); slot++)
+        {
+            encoded.push_back(has(slot) ? encode(format(getNumber(slot))) : MISSING);
+        }
+
+        ints = encoded;
+        floats.clear();
+    }
+
+    type = to;
+    invalidate();
+}
+
+const string& AttributeColumn::getName() const
+{
+    return name;
+}
+
+const AttributeColumn::Type AttributeColumn::getType() const
+{
+    return type;
+}
+
+const int AttributeColumn::getIndexes() const
+{
+    return indexes;
+}
+
+const int AttributeColumn::size() const
+{
+    return type == FLOAT ? floats.size() : ints.size();
+}
+
+const bool AttributeColumn::has(int slot) const
+{
+    if(type == FLOAT)
+    {
+        return floats[slot] == floats[slot];
+    }
+
+    return ints[slot] != MISSING;
+}
+
+// returns the value of slot as a string, or "" if it has none
+const string AttributeColumn::get(int slot) const
+{
+    if(!has(slot)) return "";
+
+    if(type == STRING)
+    {
+        return (*strings)[ints[slot]];
+    }
+
+    return format(getNumber(slot));
+}
+
+// appends the slots whose value equals value
+void AttributeColumn::find(const string& value, vector<int>& slots) const
+{
+    if(type == STRING)
+    {
+        Codes::const_iterator i = codes->find(value);
+        if(i == codes->end()) return;
+
+        int code = i->second;
+
+        if(indexes & INDEX_HASH)
+        {
+            HashIndex::const_iterator entry = getHashIndex().find(code);
+            if(entry != hashIndex->end()) slots.insert(slots.end(), entry->second.begin(), entry->second.end());
+            return;
+        }
+
+        for(int slot = 0; slot < ints.size(); slot++)
+        {
+            if(ints[slot] == code) slots.push_back(slot);
+        }
+
+        return;
+    }
+
+    double number;
+
+    if(!parseFloat(value, number)) return;
+
+    if(type == INT && (indexes & INDEX_HASH))
+    {
+        if(number != floor(number) || number <= INT_MIN || number > INT_MAX) return;
+
+        HashIndex::const_iterator entry = getHashIndex().find((int)number);
+        if(entry != hashIndex->end()) slots.insert(slots.end(), entry->second.begin(), entry->second.end());
+        return;
+    }
+
+    // floats are compared at the precision they are stored with
+    if(type == FLOAT) number = (float)number;
+
+    find(number, number, slots);
+}
+
+// appends the slots whose value is in [min, max], in order of value if the
+// column has a sorted index and in order of slot otherwise
+void AttributeColumn::find(double min, double max, vector<int>& slots) const
+{
+    if(type == STRING) return;
+
+    if(indexes & INDEX_SORTED)
+    {
+        const vector<pair<double, int> >& index = getSortedIndex();
+        vector<pair<double, int> >::const_iterator i = std::lower_bound(index.begin(), index.end(), pair<double, int>(min, INT_MIN));
+        vector<pair<double, int> >::const_iterator end = std::upper_bound(i, index.end(), pair<double, int>(max, INT_MAX));
+
+        for(; i != end; i++)
+        {
+            slots.push_back(i->second);
+        }
+
+        return;
+    }
+
+    for(int slot = 0; slot < size(); slot++)
+    {
+        if(!has(slot)) continue;
+
+        double number = getNumber(slot);
+        if(number >= min && number <= max) slots.push_back(slot);
+    }
+}
+
+void AttributeColumn::set(int slot, const string& value)
+{
+    int i;
+    double d;
+
+    // promote() drops the indexes if the type changes
+    unindex(slot);
+
+    if(type == INT && parseInt(value, i))
+    {
+        ints.edit(slot) = i;
+    }
+    else if(type != STRING && parseFloat(value, d))
+    {
+        promote(FLOAT);
+        floats.edit(slot) = d;
+    }
+    else
+    {
+        promote(STRING);
+        ints.edit(slot) = encode(value);
+    }
+
+    index(slot);
+}
+
+void AttributeColumn::set(int slot, double value)
+{
+    unindex(slot);
+
+    if(type == INT && value == floor(value) && value > INT_MIN && value <= INT_MAX)
+    {
+        ints.edit(slot) = (int)value;
+    }
+    else if(type != STRING)
+    {
+        promote(FLOAT);
+        floats.edit(slot) = value;
+    }
+    else
+    {
+        ints.edit(slot) = encode(format(value));
+    }
+
+    index(slot);
+}
+
+void AttributeColumn::setIndexes(int indexes)
+{
+    this->indexes = indexes;
+    invalidate();
+}
+
+// the new slot has no value, so the indexes stay as they are
+void AttributeColumn::push_back()
+{
+    if(type == FLOAT) floats.push_back(missingFloat);
+    else ints.push_back(MISSING);
+}
+
+void AttributeColumn::eraseSlot(int slot)
+{
+    if(type == FLOAT) ::eraseSlot(floats, slot);
+    else ::eraseSlot(ints, slot);
+
+    invalidate();
+}
+
+void AttributeColumn::clear()
+{
+    ints.clear();
+    floats.clear();
+    strings.reset(new vector<string>());
+    codes.reset(new Codes());
+    invalidate();
+}
+
+/*
+ * AttributeStore
+ */
+AttributeStore::AttributeStore()
+    : rowCount(0)
+{
+}
+
+// returns the column called name, adding it with the given type if needed
+AttributeColumn& AttributeStore::getColumn(const string& name, AttributeColumn::Type type)
+{
+    tr1::unordered_map<string, int>::iterator i = columnIds.find(name);
+
+    if(i != columnIds.end())
+    {
+        return columns[i->second];
+    }
+
+    columnIds[name] = columns.size();
+    columns.push_back(AttributeColumn(name, type, AttributeColumn::INDEX_NONE));
+
+    for(int row = 0; row < rowCount; row++)
+    {
+        columns.back().push_back();
+    }
+
+    return columns.back();
+}
+
+// declares a column ahead of its values, or changes the indexes of one
+void AttributeStore::addColumn(const string& name, AttributeColumn::Type type, int indexes)
+{
+    getColumn(name, type).setIndexes(indexes);
+}
+
+// returns 0 if there is no such column
+const AttributeColumn* AttributeStore::findColumn(const string& name) const
+{
+    tr1::unordered_map<string, int>::const_iterator i = columnIds.find(name);
+    return i == columnIds.end() ? 0 : &columns[i->second];
+}
+
+// every attribute row has a value for, in the order the columns were added
+void AttributeStore::get(int row, Attributes& attributes) const
+{
+    attributes.clear();
+
+    for(int i = 0; i < (int)columns.size(); i++)
+    {
+        if(columns[i].has(row))
+        {
+            attributes.push_back(pair<string, string>(columns[i].getName(), columns[i].get(row)));
+        }
+    }
+}
+
+void AttributeStore::find(const string& name, const string& value, vector<int>& rows) const
+{
+    rows.clear();
+
+    const AttributeColumn* column = findColumn(name);
+    if(column) column->find(value, rows);
+}
+
+void AttributeStore::find(const string& name, double min, double max, vector<int>& rows) const
+{
+    rows.clear();
+
+    const AttributeColumn* column = findColumn(name);
+    if(column) column->find(min, max, rows);
+}
+
+void AttributeStore::set(int row, const string& name, const string& value)
+{
+    int i;
+    double d;
+    AttributeColumn::Type type = AttributeColumn::STRING;
+
+    if(AttributeColumn::parseInt(value, i)) type = AttributeColumn::INT;
+    else if(AttributeColumn::parseFloat(value, d)) type = AttributeColumn::FLOAT;
+
+    getColumn(name, type).set(row, value);
+}
+
+void AttributeStore::set(int row, const string& name, double value)
+{
+    AttributeColumn::Type type = value == floor(value) ? AttributeColumn::INT : AttributeColumn::FLOAT;
+    getColumn(name, type).set(row, value);
+}
+
+void AttributeStore::push_back()
+{
+    for(int i = 0; i < (int)columns.size(); i++)
+    {
+        columns[i].push_back();
+    }
+
+    rowCount++;
+}
+
+void AttributeStore::eraseSlot(int row)
+{
+    for(int i = 0; i < (int)columns.size(); i++)
+    {
+        columns[i].eraseSlot(row);
+    }
+
+    rowCount--;
+}
+
+// drops every column
+void AttributeStore::clear()
+{
+    columns.clear();
+    columnIds.clear();
+    rowCount = 0;
+}
+
+// drops every row but keeps the columns and their types
+void AttributeStore::clearRows()
+{
+    for(int i = 0; i < (int)columns.size(); i++)
+    {
+        columns[i].clear();
+    }
+
+    rowCount = 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ATTRIBUTESTORE_HPP
+#define __ATTRIBUTESTORE_HPP
+
+#include <cowvector.hpp>
+#include <string>
+#include <vector>
+#include <tr1/unordered_map>
+#include <boost/shared_ptr.hpp>
+
+typedef std::vector<std::pair<std::string, std::string> > Attributes;
+
+/*
+ * One attribute of every node (or edge), indexed by slot. Ints and floats are
+ * stored as they are; strings are stored as codes into a dictionary, so equal
+ * strings are compared as ints and stored once. Slots without a value hold
+ * MISSING, or NaN in a float column.
+ *
+ * A column can keep a hash index (value -> slots) for equality lookups and a
+ * sorted index (slots by value) for range lookups. Both are built by the first
+ * lookup that needs them and shared by copies of the column. Setting a value
+ * updates the slot's entries in place; only a change of type, an erase or a
+ * clear drops them.
+ */
+class AttributeColumn
+{
+public:
+    enum Type { INT, FLOAT, STRING };
+
+    static const int INDEX_NONE = 0;
+    static const int INDEX_HASH = 1;
+    static const int INDEX_SORTED = 2;
+
+    static const int MISSING;
+
+private:
+    typedef std::tr1::unordered_map<int, std::vector<int> > HashIndex;
+    typedef std::tr1::unordered_map<std::string, int> Codes;
+
+    std::string name;
+    Type type;
+    int indexes;
+
+    CowVector<int> ints;     // INT values or STRING codes
+    CowVector<float> floats; // FLOAT values
+
+    // shared by copies, cloned by the first new string after one is made
+    boost::shared_ptr<std::vector<std::string> > strings;
+    boost::shared_ptr<Codes> codes;
+
+    mutable boost::shared_ptr<HashIndex> hashIndex;
+    mutable boost::shared_ptr<std::vector<std::pair<double, int> > > sortedIndex; // (value, slot)
+
+    const int encode(const std::string&);
+    const double getNumber(int) const;
+    const HashIndex& getHashIndex() const;
+    const std::vector<std::pair<double, int> >& getSortedIndex() const;
+    void index(int);
+    void unindex(int);
+    void invalidate();
+    void promote(Type);
+
+public:
+    AttributeColumn(const std::string&, Type, int);
+
+    static const bool parseInt(const std::string&, int&);
+    static const bool parseFloat(const std::string&, double&);
+
+    const std::string& getName() const;
+    const Type getType() const;
+    const int getIndexes() const;
+    const int size() const;
+    const bool has(int) const;
+    const std::string get(int) const;
+    void find(const std::string&, std::vector<int>&) const;
+    void find(double, double, std::vector<int>&) const;
+    void set(int, const std::string&);
+    void set(int, double);
+    void setIndexes(int);
+
+    void push_back();
+    void eraseSlot(int);
+    void clear();
+};
+
+/*
+ * The attribute columns of a graph's nodes or edges. Rows follow the slots of
+ * the owning SlotMap: push_back() for an insert, eraseSlot() for an erase.
+ * Setting an attribute replaces its value. A new column's type is taken from
+ * its first value; a value that doesn't fit widens the column from INT to
+ * FLOAT to STRING.
+ */
+class AttributeStore
+{
+private:
+    std::vector<AttributeColumn> columns;
+    std::tr1::unordered_map<std::string, int> columnIds;
+    int rowCount;
+
+    AttributeColumn& getColumn(const std::string&, AttributeColumn::Type);
+
+public:
+    AttributeStore();
+
+    void addColumn(const std::string&, AttributeColumn::Type, int = AttributeColumn::INDEX_NONE);
+    const AttributeColumn* findColumn(const std::string&) const;
+    void get(int, Attributes&) const;
+    void find(const std::string&, const std::string&, std::vector<int>&) const;
+    void find(const std::string&, double, double, std::vector<int>&) const;
+    void set(int, const std::string&, const std::string&);
+    void set(int, const std::string&, double);
+
+    void push_back();
+    void eraseSlot(int);
+    void clear();
+    void clearRows();
+};
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BOUNDINGSPHERE_HPP
+#define __BOUNDINGSPHERE_HPP
+
+#include <mycelia.hpp>
+#include <vector>
+
+/*
+ * A sphere around a set of points, from Ritter's algorithm: start with the
+ * two points found by walking to the farthest point twice, then grow just
+ * enough to cover each point outside. Usually within a few percent of the
+ * smallest sphere, in O(N). include() is the growth step on its own, so a
+ * sphere can follow points added one at a time.
+ */
+class BoundingSphere
+{
+public:
+    Vrui::Point center;
+    Vrui::Scalar radius; // negative if empty
+
+    BoundingSphere()
+      : center(0, 0, 0),
+        radius(-1)
+    {
+    }
+
+    const bool isEmpty() const
+    {
+        return radius < 0;
+    }
+
+    void include(const Vrui::Point& p)
+    {
+        if(isEmpty())
+        {
+            center = p;
+            radius = 0;
+            return;
+        }
+
+        Vrui::Vector v = p - center;
+        Vrui::Scalar d = Geometry::mag(v);
+
+        if(d > radius)
+        {
+            Vrui::Scalar grown = (radius + d) / 2;
+            center += v * ((grown - radius) / d);
+            radius = grown;
+        }
+    }
+
+    void fit(const std::vector<Vrui::Point>& points)
+    {
+        *this = BoundingSphere();
+        if(points.empty()) return;
+
+        int a = farthest(points, points[0]);
+        int b = farthest(points, points[a]);
+
+        center = points[a] + (points[b] - points[a]) * Vrui::Scalar(0.5);
+        radius = Geometry::mag(points[b] - points[a]) / 2;
+
+        for(int i = 0; i < (int)points.size(); i++)
+        {
+            include(points[i]);
+        }
+    }
+
+    static int farthest(const std::vector<Vrui::Point>& points, const Vrui::Point& p)
+    {
+        int best = 0;
+        Vrui::Scalar bestDistance = -1;
+
+        for(int i = 0; i < (int)points.size(); i++)
+        {
+            Vrui::Scalar d = Geometry::sqrDist(points[i], p);
+
+            if(d > bestDistance)
+            {
+                best = i;
+                bestDistance = d;
+            }
+        }
+
+        return best;
+    }
+};
+
+#endif
@@ -0,0 +1,191 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <changelog.hpp>
+
+using namespace std;
+
+static void mark(vector<bool>& bits, int id)
+{
+    if(id < 0) return;
+
+    if(id >= (int)bits.size())
+    {
+        bits.resize(id + 1, false);
+    }
+
+    bits[id] = true;
+}
+
+/*
+ * change sets
+ */
+ChangeSet::ChangeSet()
+{
+    clear();
+}
+
+void ChangeSet::clear()
+{
+    reload = false;
+    redrawn = false;
+    allPositions = false;
+    allStyles = false;
+    positions.clear();
+    nodeStyles.clear();
+    edgeStyles.clear();
+    nodeLabels.clear();
+    edgeLabels.clear();
+    topology.clear();
+    structure.clear();
+    removals = 0;
+}
+
+const bool ChangeSet::isEmpty() const
+{
+    return !reload && !redrawn && !hasPositions() && !hasStyles() && !hasTopology()
+        && nodeLabels.empty() && edgeLabels.empty();
+}
+
+const bool ChangeSet::hasPositions() const
+{
+    return reload || allPositions || !positions.empty();
+}
+
+const bool ChangeSet::hasStyles() const
+{
+    return reload || allStyles || !nodeStyles.empty() || !edgeStyles.empty();
+}
+
+const bool ChangeSet::hasTopology() const
+{
+    return reload || !structure.empty();
+}
+
+/*
+ * change log
+ */
+ChangeLog::ChangeLog()
+    : base(0)
+{
+}
+
+// catches up with a log this one was copied from
+void ChangeLog::follow(const ChangeLog& log)
+{
+    int version = getVersion();
+
+    if(version < log.base || version > log.getVersion())
+    {
+        *this = log;
+        return;
+    }
+
+    entries.insert(entries.end(), log.entries.begin() + (version - log.base), log.entries.end());
+
+    // down to half, as record() does, so a full log isn't shifted every time
+    if((int)entries.size() > CAPACITY)
+    {
+        int dropped = entries.size() - CAPACITY / 2;
+        entries.erase(entries.begin(), entries.begin() + dropped);
+        base += dropped;
+    }
+}
+
+// fills changes with everything after version since, returns the version now
+const int ChangeLog::getChanges(int since, ChangeSet& changes) const
+{
+    changes.clear();
+
+    if(since < base)
+    {
+        changes.reload = true;
+        return getVersion();
+    }
+
+    for(int i = since - base; i < (int)entries.size(); i++)
+    {
+        const Change& c = entries[i];
+
+        switch(c.kind)
+        {
+        case NODE_ADDED:
+        case NODE_REMOVED:
+            mark(changes.topology, c.id);
+            changes.structure.push_back(c);
+            if(c.kind == NODE_REMOVED) changes.removals++;
+            break;
+        case EDGE_ADDED:
+        case EDGE_REMOVED:
+            mark(changes.topology, c.source);
+            mark(changes.topology, c.target);
+            changes.structure.push_back(c);
+            if(c.kind == EDGE_REMOVED) changes.removals++;
+            break;
+        case NODE_MOVED:
+            mark(changes.positions, c.id);
+            break;
+        case NODES_MOVED:
+            changes.allPositions = true;
+            break;
+        case NODE_STYLED:
+            mark(changes.nodeStyles, c.id);
+            break;
+        case NODES_STYLED:
+            changes.allStyles = true;
+            break;
+        case EDGE_STYLED:
+            mark(changes.edgeStyles, c.id);
+            break;
+        case NODE_LABELED:
+            mark(changes.nodeLabels, c.id);
+            break;
+        case EDGE_LABELED:
+            mark(changes.edgeLabels, c.id);
+            break;
+        case REDRAWN:
+            changes.redrawn = true;
+            break;
+        }
+    }
+
+    return getVersion();
+}
+
+const int ChangeLog::getVersion() const
+{
+    return base + entries.size();
+}
+
+void ChangeLog::record(int kind, int id, int source, int target)
+{
+    if((int)entries.size() == CAPACITY)
+    {
+        entries.erase(entries.begin(), entries.begin() + CAPACITY / 2);
+        base += CAPACITY / 2;
+    }
+
+    entries.push_back(Change(kind, id, source, target));
+}
+
+// forgets every entry, consumers that haven't caught up get a reload
+void ChangeLog::reset()
+{
+    base = getVersion() + 1;
+    entries.clear();
+}
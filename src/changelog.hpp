@@ -0,0 +1,120 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CHANGELOG_HPP
+#define __CHANGELOG_HPP
+
+#include <vector>
+
+class Change
+{
+public:
+    int kind;
+    int id;
+    int source; // edges only
+    int target;
+
+    Change(int kind, int id, int source = -1, int target = -1)
+      : kind(kind),
+        id(id),
+        source(source),
+        target(target)
+    {
+    }
+};
+
+/*
+ * What changed between two change log versions. The bitsets are indexed by
+ * node or edge id and only as long as the largest id marked; structure keeps
+ * node and edge additions and removals in the order they happened.
+ */
+class ChangeSet
+{
+public:
+    bool reload;       // the log doesn't reach back that far, assume everything
+    bool redrawn;      // Graph::redraw(), the picture changed outside the graph
+    bool allPositions; // every node moved
+    bool allStyles;    // something that applies to every node
+
+    std::vector<bool> positions;  // nodes
+    std::vector<bool> nodeStyles; // nodes drawn differently
+    std::vector<bool> edgeStyles; // edges drawn differently
+    std::vector<bool> nodeLabels; // new labels or attributes, not drawn in lists
+    std::vector<bool> edgeLabels;
+    std::vector<bool> topology;   // nodes added or removed, or gaining or losing edges
+    std::vector<Change> structure;
+
+    int removals; // entries of structure that are removals
+
+    ChangeSet();
+
+    void clear();
+
+    const bool isEmpty() const;
+    const bool hasPositions() const;
+    const bool hasStyles() const;
+    const bool hasTopology() const;
+
+    static const bool isMarked(const std::vector<bool>& bits, int id)
+    {
+        return id < (int)bits.size() && bits[id];
+    }
+};
+
+/*
+ * A journal of graph changes, for consumers that want to do work in
+ * proportion to what changed instead of rebuilding on every version. Each
+ * record() advances the version by one. Consumers remember the version they
+ * last saw and ask for the changes since; the log only keeps the newest
+ * CAPACITY entries, so a consumer that fell further behind gets a reload.
+ */
+class ChangeLog
+{
+private:
+    std::vector<Change> entries;
+    int base; // version before entries[0]
+
+public:
+    enum Kind
+    {
+        NODE_ADDED,
+        NODE_REMOVED,
+        EDGE_ADDED,
+        EDGE_REMOVED,
+        NODE_MOVED,
+        NODES_MOVED,
+        NODE_STYLED,
+        NODES_STYLED,
+        EDGE_STYLED,
+        NODE_LABELED,
+        EDGE_LABELED,
+        REDRAWN
+    };
+
+    static const int CAPACITY = 1 << 16;
+
+    ChangeLog();
+
+    void follow(const ChangeLog&);
+    const int getChanges(int, ChangeSet&) const;
+    const int getVersion() const;
+    void record(int, int = -1, int = -1, int = -1);
+    void reset();
+};
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __COWVECTOR_HPP
+#define __COWVECTOR_HPP
+
+#include <algorithm>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+/*
+ * A vector stored as fixed size chunks that are shared copy-on-write.
+ *
+ * Copying a CowVector only copies the chunk pointers, so a graph snapshot
+ * costs O(size / CHUNK_SIZE). The first edit() of a shared chunk clones that
+ * chunk alone; the other copies keep seeing the old contents.
+ */
+template <class T>
+class CowVector
+{
+private:
+    typedef std::vector<T> Chunk;
+
+    std::vector<boost::shared_ptr<Chunk> > chunks;
+    int count;
+
+    Chunk& detach(int chunk)
+    {
+        if(!chunks[chunk].unique())
+        {
+            chunks[chunk].reset(new Chunk(*chunks[chunk]));
+        }
+
+        return *chunks[chunk];
+    }
+
+public:
+    static const int CHUNK_SIZE = 256;
+
+    CowVector() : count(0) {}
+
+    const T& operator[](int i) const
+    {
+        return (*chunks[i / CHUNK_SIZE])[i % CHUNK_SIZE];
+    }
+
+    // returns a writable element, cloning its chunk if it is shared
+    T& edit(int i)
+    {
+        return detach(i / CHUNK_SIZE)[i % CHUNK_SIZE];
+    }
+
+    void push_back(const T& value)
+    {
+        if(count % CHUNK_SIZE == 0)
+        {
+            chunks.push_back(boost::shared_ptr<Chunk>(new Chunk()));
+            chunks.back()->reserve(CHUNK_SIZE);
+        }
+
+        detach(chunks.size() - 1).push_back(value);
+        count++;
+    }
+
+    void pop_back()
+    {
+        detach(chunks.size() - 1).pop_back();
+        count--;
+
+        if(count % CHUNK_SIZE == 0)
+        {
+            chunks.pop_back();
+        }
+    }
+
+    void clear()
+    {
+        chunks.clear();
+        count = 0;
+    }
+
+    const int size() const
+    {
+        return count;
+    }
+};
+
+// Mirrors SlotMap::erase() on a slot-indexed CowVector.
+template <class T>
+inline void eraseSlot(CowVector<T>& v, int slot)
+{
+    int last = v.size() - 1;
+
+    if(slot != last)
+    {
+        std::swap(v.edit(slot), v.edit(last));
+    }
+
+    v.pop_back();
+}
+
+#endif
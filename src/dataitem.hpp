@@ -19,6 +19,7 @@
 #ifndef __DATAITEM_HPP
 #define __DATAITEM_HPP
 
+#include <changelog.hpp>
 #include <mycelia.hpp>
 
 #include <map>
@@ -45,6 +46,13 @@ public:
     typedef std::pair< GLuint, SizePair > TexturePair;
 
     int graphListVersion;
+    int graphListChanges; // change log version the list was last checked at
+    ChangeSet changes;
+
+    // graphList calls these, one per NODES_PER_LIST slots, see
+    // Mycelia::updateGraphList()
+    std::vector<GLuint> nodeLists;
+    std::vector<int> drawn; // by target slot, see Mycelia::drawEdges()
 
     // fonts
     FTFont* font;
@@ -60,10 +68,8 @@ public:
         graphList = glGenLists(1);
         nodeList = glGenLists(1);
 
-        textureIds.resize(1000); // reserve 1000 textures
-        glGenTextures(1000, &textureIds[0]);
-
         graphListVersion = 0;
+        graphListChanges = -1;
     }
 
     ~MyceliaDataItem()
@@ -76,10 +82,29 @@ public:
         glDeleteLists(arrowList, 1);
         glDeleteLists(graphList, 1);
         glDeleteLists(nodeList, 1);
-        glDeleteTextures(textureIds.size(), &textureIds[0]);
+        resizeNodeLists(0);
+
+        if(!textureIds.empty())
+        {
+            glDeleteTextures(textureIds.size(), &textureIds[0]);
+        }
     }
 
-    TexturePair getTextureId(std::string imagePath)
+    void resizeNodeLists(int count)
+    {
+        while((int)nodeLists.size() < count)
+        {
+            nodeLists.push_back(glGenLists(1));
+        }
+
+        while((int)nodeLists.size() > count)
+        {
+            glDeleteLists(nodeLists.back(), 1);
+            nodeLists.pop_back();
+        }
+    }
+
+    TexturePair getTextureId(const std::string& imagePath)
     {
         if (imagePath == "")
         {
@@ -110,20 +135,11 @@ public:
         }
         SizePair size(image.getWidth(), image.getHeight());
 
-        // grab a pregenerated texture id or generate a new one
+        // generate a texture id for each image the first time it's drawn
         //
-        unsigned int numCachedTextures = textureIndexMap.size();
-        unsigned int imageIdIndex;
-        if ( numCachedTextures < textureIds.size() )
-        {
-        }
-        else
-        {
-            // make room for another texture id
-            textureIds.push_back(0);
-            glGenTextures(1, &(textureIds[0]) + numCachedTextures);
-        }
-        imageIdIndex = numCachedTextures;
+        size_t imageIdIndex = textureIds.size();
+        textureIds.push_back(0);
+        glGenTextures(1, &textureIds[imageIdIndex]);
         textureIndexMap[imagePath] = imageIdIndex;
         textureSizeMap[imagePath] = size;
         GLuint imageId = textureIds[imageIdIndex];
@@ -34,15 +34,19 @@ void BarabasiGenerator::generate() const
 void BarabasiGenerator::generateNodes(int nodeCount) const
 {
     application->g->clear();
+    application->g->beginBatch(nodeCount);
     
     for(int i = 0; i < nodeCount; i++)
     {
         application->g->addNode();
     }
+    
+    application->g->commit();
 }
 
 void BarabasiGenerator::generateEdges(int initialNodeCount, int maxNodeCount) const
 {
+    application->g->beginBatch();
     application->g->clearEdges();
     
     for(int i = 0; i < initialNodeCount; i++)
@@ -64,4 +68,6 @@ void BarabasiGenerator::generateEdges(int initialNodeCount, int maxNodeCount) co
             }
         }
     }
+    
+    application->g->commit();
 }
\ No newline at end of file
@@ -36,15 +36,19 @@ void ErdosGenerator::generate() const
 void ErdosGenerator::generateNodes(int nodeCount) const
 {
     application->g->clear();
+    application->g->beginBatch(nodeCount);
     
     for(int i = 0; i < nodeCount; i++)
     {
         application->g->addNode();
     }
+    
+    application->g->commit();
 }
 
 void ErdosGenerator::generateEdges(float p) const
 {
+    application->g->beginBatch();
     application->g->clearEdges();
     
     foreach(int sourceNode, application->g->getNodes())
@@ -59,4 +63,6 @@ void ErdosGenerator::generateEdges(float p) const
             }
         }
     }
+    
+    application->g->commit();
 }
\ No newline at end of file
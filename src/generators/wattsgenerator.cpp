@@ -34,15 +34,19 @@ void WattsGenerator::generate() const
 void WattsGenerator::generateNodes(int nodeCount) const
 {
     application->g->clear();
+    application->g->beginBatch(nodeCount);
     
     for(int i = 0; i < nodeCount; i++)
     {
         application->g->addNode();
     }
+    
+    application->g->commit();
 }
 
 void WattsGenerator::generateEdges(int nodeCount, float beta) const
 {
+    application->g->beginBatch();
     application->g->clearEdges();
     
     for(int i = 0; i < nodeCount; i++)
@@ -50,7 +54,7 @@ void WattsGenerator::generateEdges(int nodeCount, float beta) const
         application->g->addEdge(i, (i + 1) % nodeCount);
     }
     
-    set<int> edgesCopy = application->g->getEdges();
+    vector<int> edgesCopy = application->g->getEdges();
     
     // this is probably not correct
     foreach(int edge, edgesCopy)
@@ -72,4 +76,6 @@ void WattsGenerator::generateEdges(int nodeCount, float beta) const
             application->g->addEdge(node, candidateNode);
         }
     }
+    
+    application->g->commit();
 }
\ No newline at end of file
@@ -17,10 +17,33 @@
  */
 
 #include <graph.hpp>
+#include <graphtraits.hpp>
 
 using namespace std;
 
-Graph::Graph(Mycelia* application): application(application)
+// The graph the calling thread holds an open batch on, and how deeply nested.
+// Thread-local, so lock() can tell whether to skip the mutex without reading
+// anything another thread writes.
+static __thread const Graph* batchGraph = 0;
+static __thread int batchDepth = 0;
+
+// what the node getters return for ids that aren't nodes
+static const Node missingNode;
+static const Vrui::Vector missingVelocity(0, 0, 0);
+
+Graph::Graph(Mycelia* application)
+    : application(application),
+      lastMaxDistance(0),
+      topologyVersion(0),
+      styleVersion(0),
+      weightVersion(0),
+      positionVersion(0),
+      adjacencyTopologyVersion(-1),
+      adjacencyWeightVersion(-1),
+      focus(FOCUS_ALL),
+      focusVersion(0),
+      activeTopologyVersion(-1),
+      activeFocusVersion(-1)
 {
     init();
 }
@@ -29,14 +52,35 @@ Graph& Graph::operator=(const Graph& g)
 {
     application = g.application;
     version = g.version;
-
-    nodes = g.nodes;
-    nodeMap = g.nodeMap;
-
-    edges = g.edges;
-    edgeMap = g.edgeMap;
-
-    materialVector = g.materialVector;
+    topologyVersion = g.topologyVersion;
+    styleVersion = g.styleVersion;
+    weightVersion = g.weightVersion;
+    positionVersion = g.positionVersion;
+
+    nodeSlots = g.nodeSlots;
+    nodeVector = g.nodeVector;
+    g.positions.read(positionScratch);
+    positions.beginWrite();
+    positions.assign(positionScratch);
+    positions.endWrite();
+    boundsValid = false;
+    velocityVector = g.velocityVector;
+    sizeVector = g.sizeVector;
+    nodeMaterialVector = g.nodeMaterialVector;
+    nodeAttributes = g.nodeAttributes;
+
+    edgeSlots = g.edgeSlots;
+    edgeVector = g.edgeVector;
+    incidences = g.incidences;
+    edgeAttributes = g.edgeAttributes;
+
+    palette = g.palette;
+    strings = g.strings;
+    changeLog = g.changeLog;
+    focus = g.focus;
+    focusVersion = g.focusVersion;
+    adjacency.reset();
+    activeNodes.reset();
     textureNodeMode = g.textureNodeMode;
 
     return *this;
@@ -45,58 +89,143 @@ Graph& Graph::operator=(const Graph& g)
 /*
  * general
  */
+
+/*
+ * Brings this graph up to date with g. Node and edge records are shared
+ * copy-on-write, so only the slot arrays whose version moved get copied, and
+ * nothing does if g hasn't changed. The lock on g is held just long enough to
+ * copy chunk pointers and those arrays; positions are copied after releasing
+ * it, through their sequence lock.
+ */
+void Graph::acquireSnapshot(Graph& g)
+{
+    g.mutex.lock();
+
+    bool topologyChanged = topologyVersion != g.topologyVersion;
+    bool styleChanged = topologyChanged || styleVersion != g.styleVersion;
+    bool positionChanged = topologyChanged || positionVersion != g.positionVersion;
+    unsigned int generation = g.positions.getGeneration();
+
+    application = g.application;
+    version = g.version;
+
+    if(topologyChanged)
+    {
+        nodeSlots = g.nodeSlots;
+        edgeSlots = g.edgeSlots;
+        incidences = g.incidences;
+
+        // only the layouts read velocities, so snapshots don't carry them
+        velocityVector.assign(g.velocityVector.size(), Vrui::Vector(0, 0, 0));
+    }
+
+    if(styleChanged)
+    {
+        nodeVector = g.nodeVector;
+        edgeVector = g.edgeVector;
+        sizeVector = g.sizeVector;
+        nodeMaterialVector = g.nodeMaterialVector;
+        nodeAttributes = g.nodeAttributes;
+        edgeAttributes = g.edgeAttributes;
+        palette = g.palette;
+        strings.follow(g.strings);
+        textureNodeMode = g.textureNodeMode;
+        focus = g.focus;
+        focusVersion = g.focusVersion;
+    }
+
+    topologyVersion = g.topologyVersion;
+    styleVersion = g.styleVersion;
+    weightVersion = g.weightVersion;
+    positionVersion = g.positionVersion;
+    changeLog.follow(g.changeLog);
+
+    g.mutex.unlock();
+
+    if(positionChanged)
+    {
+        // slots moved since we let go, so these don't line up with nodeSlots
+        if(g.positions.read(positionScratch) != generation)
+        {
+            g.mutex.lock();
+            g.positions.read(positionScratch);
+            g.mutex.unlock();
+        }
+
+        positions.beginWrite();
+        positions.assign(positionScratch);
+        positions.endWrite();
+        boundsValid = false;
+    }
+}
+
 void Graph::clear()
 {
     application->stopLayout();
-    mutex.lock();
+    lock();
 
     init();
 
-    mutex.unlock();
+    unlock();
     application->clearSelections();
 }
 
 void Graph::clearVelocities()
 {
-    mutex.lock();
+    lock();
 
-    foreach(int node, nodes)
-    {
-        nodeMap[node].velocity = Vrui::Vector(0, 0, 0);
-    }
+    std::fill(velocityVector.begin(), velocityVector.end(), Vrui::Vector(0, 0, 0));
 
-    mutex.unlock();
+    unlock();
 }
 
 void Graph::init()
 {
-    nodes.clear();
-    nodeMap.clear();
-    nodeMap.rehash(1000);
-
-    edges.clear();
-    edgeMap.clear();
-    edgeMap.rehash(1000);
-
-    // TODO: Move back to dataitem.cpp
-    materialVector.clear();
-    materialVector.resize(5);
-    materialVector[MATERIAL_NODE_DEFAULT] = new GLMaterial(GLMaterial::Color(0.0, 1.0, 1.0));
-    materialVector[MATERIAL_EDGE_DEFAULT] = new GLMaterial(GLMaterial::Color(0.5, 0.5, 0.5));
-    materialVector[MATERIAL_HIGHLIGHTED] = new GLMaterial(GLMaterial::Color(1.0, .980392, .80392));
-    materialVector[MATERIAL_SELECTED] = new GLMaterial(GLMaterial::Color(1.0, 0.5, 1.0));
-    materialVector[MATERIAL_SELECTED_PREVIOUS] = new GLMaterial(GLMaterial::Color(1.0, 0.0, 1.0));
-
+    nodeSlots.clear();
+    nodeVector.clear();
+    positions.beginWrite();
+    positions.clear();
+    positions.endWrite();
+    velocityVector.clear();
+    sizeVector.clear();
+    nodeMaterialVector.clear();
+    nodeAttributes.clear();
+
+    edgeSlots.clear();
+    edgeVector.clear();
+    incidences.clear();
+    edgeAttributes.clear();
+    pendingEdges.clear();
+
+    // pinned in the order of the MATERIAL_ ids
+    palette.reset(new MaterialPalette());
+    palette->pin(GLMaterial::Color(0.0, 1.0, 1.0));      // MATERIAL_NODE_DEFAULT
+    palette->pin(GLMaterial::Color(0.5, 0.5, 0.5));      // MATERIAL_EDGE_DEFAULT
+    palette->pin(GLMaterial::Color(1.0, 0.5, 1.0));      // MATERIAL_SELECTED
+    palette->pin(GLMaterial::Color(1.0, 0.0, 1.0));      // MATERIAL_SELECTED_PREVIOUS
+    palette->pin(GLMaterial::Color(1.0, .980392, .80392)); // MATERIAL_HIGHLIGHTED
+
+    strings.clear();
     textureNodeMode = "align";
 
     version = -1;
-    nodeId = -1;
-    edgeId = -1;
+    changeLog.reset();
+    componentMembers.clear();
+    componentsVersion = -1;
+    focus = FOCUS_ALL;
+    focusVersion++;
+    topologyVersion++;
+    styleVersion++;
+    positionVersion++;
 
     lastCenter[0] = 0;
     lastCenter[1] = 0;
     lastCenter[2] = 0;
 
+    bounds = BoundingSphere();
+    boundsValid = true;
+    boundsTight = true;
+
     /** We will change the lastMaxDistance for two reasons:
 
           1) it has never been set
@@ -111,40 +240,37 @@ void Graph::init()
     }
 }
 
+// Returns the center and diameter of the active nodes.
 const pair<Vrui::Point, Vrui::Scalar> Graph::locate()
 {
-    Vrui::Point center(0, 0, 0);
-    Vrui::Scalar maxDistance = 0;
-    int counted = 1;
+    BoundingSphere sphere;
 
-    mutex.lock();
+    lock();
+    flushIfBatching();
+
+    const ActiveNodes& active = *refreshActiveNodes();
 
-    foreach(int source, nodes)
+    if(active.all)
     {
-        if(!application->isSelectedComponent(source))
-        {
-            continue;
-        }
+        sphere = getBounds(true);
+    }
+    else
+    {
+        vector<Vrui::Point> selected;
 
-        foreach(int target, nodes)
+        foreach(int slot, active.slots)
         {
-            if(!application->isSelectedComponent(target))
-            {
-                continue;
-            }
-
-            Vrui::Scalar d = Geometry::mag(nodeMap[source].position - nodeMap[target].position);
-            if(d > maxDistance) maxDistance = d;
+            selected.push_back(positions[slot]);
         }
 
-        center += (nodeMap[source].position - center) * (1.0 / counted);
-
-        counted++;
+        sphere.fit(selected);
     }
 
-    mutex.unlock();
+    unlock();
 
-    if(maxDistance == 0) maxDistance = 30;
+    Vrui::Point center = sphere.isEmpty() ? Vrui::Point(0, 0, 0) : sphere.center;
+    Vrui::Scalar maxDistance = 2 * sphere.radius;
+    if(maxDistance <= 0) maxDistance = 30;
 
     lastCenter = center;
     lastMaxDistance = maxDistance;
@@ -152,24 +278,74 @@ const pair<Vrui::Point, Vrui::Scalar> Graph::locate()
     return pair<Vrui::Point, Vrui::Scalar>(center, maxDistance);
 }
 
+// Refits the bounds if they are stale, or if tight is set and they may be
+// loose. Caller must hold the mutex.
+const BoundingSphere& Graph::getBounds(bool tight)
+{
+    if(!boundsValid || (tight && !boundsTight))
+    {
+        positions.read(positionScratch);
+        bounds.fit(positionScratch);
+        boundsValid = true;
+        boundsTight = true;
+    }
+
+    return bounds;
+}
+
+// Keeps the bounds covering a node that moves from its old position at slot
+// to position. Caller must hold the mutex.
+void Graph::includeInBounds(int slot, const Vrui::Point& position)
+{
+    if(!boundsValid) return;
+
+    if(Geometry::dist(positions[slot], bounds.center) > 0.9 * bounds.radius)
+    {
+        boundsTight = false;
+    }
+
+    bounds.include(position);
+}
+
 const GLMaterial* Graph::getNodeMaterialFromId(int materialId)
 {
-    if(materialId < 0 || materialId >= (int)materialVector.size())
+    if(!palette->isValid(materialId))
     {
-        return materialVector[MATERIAL_NODE_DEFAULT];
+        return &palette->getMaterial(MATERIAL_NODE_DEFAULT);
     }
 
-    return materialVector[materialId];
+    return &palette->getMaterial(materialId);
 }
 
 const GLMaterial* Graph::getEdgeMaterialFromId(int materialId)
 {
-    if(materialId < 0 || materialId >= (int)materialVector.size())
+    if(!palette->isValid(materialId))
+    {
+        return &palette->getMaterial(MATERIAL_EDGE_DEFAULT);
+    }
+
+    return &palette->getMaterial(materialId);
+}
+
+// caller must hold the mutex
+MaterialPalette& Graph::editPalette()
+{
+    if(!palette.unique())
     {
-        return materialVector[MATERIAL_EDGE_DEFAULT];
+        palette.reset(new MaterialPalette(*palette));
     }
 
-    return materialVector[materialId];
+    return *palette;
+}
+
+// caller must hold the mutex
+void Graph::releaseMaterial(int materialId)
+{
+    // the builtin materials are pinned, don't clone the palette for them
+    if(materialId > MATERIAL_HIGHLIGHTED)
+    {
+        editPalette().release(materialId);
+    }
 }
 
 const std::string& Graph::getTextureNodeMode() const
@@ -177,11 +353,39 @@ const std::string& Graph::getTextureNodeMode() const
     return textureNodeMode;
 }
 
+// bytes spent on incidence lists, free spans and list headers included
+const long Graph::getAdjacencyBytes() const
+{
+    return incidences.getBytes() + 2 * (long)nodeVector.size() * sizeof(AdjacencyList);
+}
+
+// fills changes with everything since version, returns the version now
+const int Graph::getChanges(int version, ChangeSet& changes)
+{
+    lock();
+    int current = changeLog.getVersion();
+    changeLog.getChanges(version, changes);
+    unlock();
+
+    return current;
+}
+
 const int Graph::getVersion() const
 {
     return version;
 }
 
+// bumped whenever a node or edge is added or removed, see Adjacency
+const int Graph::getTopologyVersion()
+{
+    lock();
+    flushIfBatching();
+    int result = topologyVersion;
+    unlock();
+
+    return result;
+}
+
 void Graph::randomizePositions(Vrui::Scalar radius)
 {
     if (radius < 0)
@@ -189,61 +393,207 @@ void Graph::randomizePositions(Vrui::Scalar radius)
         radius = lastMaxDistance / 2;
     }
 
-    mutex.lock();
+    lock();
 
     Vrui::Scalar x,y,z;
-    foreach(int node, nodes)
+    positions.beginWrite();
+    for(int slot = 0; slot < nodeSlots.size(); slot++)
     {
         x = radius * (2 * VruiHelp::randomFloat() - 1);
         y = radius * (2 * VruiHelp::randomFloat() - 1);
         z = radius * (2 * VruiHelp::randomFloat() - 1);
-        nodeMap[node].position = Vrui::Point(x, y, z);
+        positions[slot] = Vrui::Point(x, y, z);
     }
+    positions.endWrite();
+    positionVersion++;
+    changeLog.record(ChangeLog::NODES_MOVED);
+    boundsValid = false;
 
-    mutex.unlock();
+    unlock();
     update();
 }
 
 void Graph::setTextureNodeMode(std::string& mode)
 {
-    mutex.lock();
+    lock();
 
     textureNodeMode = mode;
+    styleVersion++;
+    changeLog.record(ChangeLog::NODES_STYLED);
 
-    mutex.unlock();
+    unlock();
+    update();
+}
+
+// deferred to commit() on the thread that holds an open batch
+// for changes outside the graph that still change how it's drawn
+void Graph::redraw()
+{
+    lock();
+    changeLog.record(ChangeLog::REDRAWN);
+    unlock();
     update();
 }
 
 void Graph::update()
 {
+    if(isBatchOwner()) return;
+
     version++;
     Vrui::requestUpdate();
 }
 
-void Graph::write(const char* filename)
+/*
+ * Opens a batch of changes on the calling thread. The mutex is taken once and
+ * held until the matching commit(), and every Graph call made meanwhile by
+ * this thread skips locking and update(). Edges added in a batch don't join
+ * the incidence lists until something on this thread needs them, or commit.
+ * Other threads block until commit(), so never call clear() or stop the
+ * layout inside a batch. Batches nest; only the outermost commit() counts.
+ */
+void Graph::beginBatch(int nodeCount, int edgeCount)
 {
+    if(isBatchOwner())
+    {
+        batchDepth++;
+        return;
+    }
+
     mutex.lock();
 
+    // a count too large to reserve must not leave the mutex held, or the
+    // positions mid write
+    bool writing = false;
+
+    try
+    {
+        int nodes = nodeSlots.size() + nodeCount;
+        nodeSlots.reserve(nodeSlots.getIdBound() + nodeCount);
+        positions.beginWrite();
+        writing = true;
+        positions.reserve(nodes);
+        positions.endWrite();
+        writing = false;
+        velocityVector.reserve(nodes);
+        sizeVector.reserve(nodes);
+        nodeMaterialVector.reserve(nodes);
+
+        edgeSlots.reserve(edgeSlots.getIdBound() + edgeCount);
+        pendingEdges.reserve(edgeCount);
+    }
+    catch(...)
+    {
+        if(writing) positions.endWrite();
+        mutex.unlock();
+        throw;
+    }
+
+    batchGraph = this;
+    batchDepth = 1;
+}
+
+// ends the batch with a single version bump
+void Graph::commit()
+{
+    if(!isBatchOwner())
+    {
+        cout << "commit without beginBatch" << endl;
+        return;
+    }
+
+    if(--batchDepth > 0) return;
+
+    flushEdges();
+    batchGraph = 0;
+
+    mutex.unlock();
+    update();
+}
+
+// no-ops on the thread that holds an open batch
+void Graph::lock()
+{
+    if(!isBatchOwner()) mutex.lock();
+}
+
+void Graph::unlock()
+{
+    if(!isBatchOwner()) mutex.unlock();
+}
+
+const bool Graph::isBatchOwner() const
+{
+    return batchGraph == this;
+}
+
+// Adds edges from the current batch to the incidence lists. Caller must hold
+// the mutex.
+void Graph::flushEdges()
+{
+    foreach(int edge, pendingEdges)
+    {
+        Edge& e = edgeVector.edit(edgeSlots.getSlot(edge));
+
+        Node& source = nodeVector.edit(nodeSlots.getSlot(e.source));
+        e.outIndex = incidences.push_back(source.outEdges, Incidence(e.target, edge));
+
+        Node& target = nodeVector.edit(nodeSlots.getSlot(e.target));
+        e.inIndex = incidences.push_back(target.inEdges, Incidence(e.source, edge));
+    }
+
+    pendingEdges.clear();
+
+    if(incidences.isFragmented()) compactIncidences();
+}
+
+// Repacks every incidence list into a fresh pool, dropping the free spans left
+// behind by growing lists and deleted nodes. Order within each list is kept,
+// so the edges' outIndex and inIndex stay valid. Caller must hold the mutex.
+void Graph::compactIncidences()
+{
+    AdjacencyPool pool;
+
+    for(int slot = 0; slot < nodeVector.size(); slot++)
+    {
+        Node& n = nodeVector.edit(slot);
+        n.outEdges = pool.append(incidences, n.outEdges);
+        n.inEdges = pool.append(incidences, n.inEdges);
+    }
+
+    incidences = pool;
+}
+
+// lets the batch owner read incidence lists that are up to date
+void Graph::flushIfBatching()
+{
+    if(isBatchOwner()) flushEdges();
+}
+
+void Graph::write(const char* filename)
+{
+    lock();
+
     ofstream out(filename);
     out << "digraph G {" << endl;
 
-    foreach(int node, nodes)
+    for(int slot = 0; slot < nodeSlots.size(); slot++)
     {
-        out << "  n" << node << "[ pos=\""
-            << nodeMap[node].position[0] << ","
-            << nodeMap[node].position[1] << ","
-            << nodeMap[node].position[2] << "\" ];\n";
+        out << "  n" << nodeSlots.getId(slot) << "[ pos=\""
+            << positions[slot][0] << ","
+            << positions[slot][1] << ","
+            << positions[slot][2] << "\" ];\n";
     }
 
-    foreach(int edge, edges)
+    for(int slot = 0; slot < edgeVector.size(); slot++)
     {
-        out << "  n" << edgeMap[edge].source << " -> n" << edgeMap[edge].target << ";\n";
+        const Edge& e = edgeVector[slot];
+        out << "  n" << e.source << " -> n" << e.target << ";\n";
     }
 
     out << "}\n";
     cout << "wrote " << filename << endl;
 
-    mutex.unlock();
+    unlock();
 }
 
 /*
@@ -251,114 +601,238 @@ void Graph::write(const char* filename)
  */
 const int Graph::addEdge(int source, int target)
 {
-    mutex.lock();
+    lock();
 
     if(!isValidNode(source) || !isValidNode(target))
     {
         cout << "invalid node(s): " << source << " " << target << endl;
-        mutex.unlock();
+        unlock();
         return -1;
     }
 
-    edgeId++;
-    edges.insert(edgeId);
-    edgeMap[edgeId] = Edge(source, target);
+    int edge = edgeSlots.insert();
+    edgeVector.push_back(Edge(source, target));
+    edgeAttributes.push_back();
+    pendingEdges.push_back(edge);
+    topologyVersion++;
+    changeLog.record(ChangeLog::EDGE_ADDED, edge, source, target);
 
-    nodeMap[source].outDegree++;
-    nodeMap[target].inDegree++;
-    nodeMap[source].adjacent[target].push_back(edgeId);
+    // a batch leaves the incidence lists until they are needed
+    if(!isBatchOwner()) flushEdges();
 
-    mutex.unlock();
+    unlock();
     update();
 
-    return edgeId;
+    return edge;
 }
 
 void Graph::clearEdges()
 {
-    mutex.lock();
+    lock();
 
-    foreach(int node, nodes)
+    for(int slot = 0; slot < nodeVector.size(); slot++)
     {
-        nodeMap[node].adjacent.clear();
+        Node& n = nodeVector.edit(slot);
+        n.outEdges = AdjacencyList();
+        n.inEdges = AdjacencyList();
     }
 
-    edges.clear();
-    edgeMap.clear();
+    incidences.clear();
 
-    mutex.unlock();
+    pendingEdges.clear();
+
+    for(int slot = 0; slot < edgeVector.size(); slot++)
+    {
+        const Edge& e = edgeVector[slot];
+        releaseMaterial(e.material);
+        strings.release(e.label);
+        changeLog.record(ChangeLog::EDGE_REMOVED, edgeSlots.getId(slot), e.source, e.target);
+    }
+
+    edgeSlots.clear();
+    edgeVector.clear();
+    edgeAttributes.clearRows();
+    topologyVersion++;
+
+    unlock();
     update();
 }
 
 const int Graph::deleteEdge(int edge)
 {
-    mutex.lock();
+    lock();
 
     if(!isValidEdge(edge))
     {
-        mutex.unlock();
+        unlock();
         return -1;
     }
 
-    Edge& e = edgeMap[edge];
-    list<int>& neighbors = nodeMap[e.source].adjacent[e.target];
-    neighbors.erase(find(neighbors.begin(), neighbors.end(), edge));
+    flushIfBatching();
+    eraseEdge(edge);
+    topologyVersion++;
 
-    edges.erase(edge);
-    edgeMap.erase(edge);
-
-    mutex.unlock();
+    unlock();
     update();
 
     return edge;
 }
 
+// Removes the edge from both incidence lists by moving the last entry of each
+// list into its place. Caller must hold the mutex.
+void Graph::eraseEdge(int edge)
+{
+    const Edge& e = edgeVector[edgeSlots.getSlot(edge)];
+    int sourceSlot = nodeSlots.getSlot(e.source);
+    int targetSlot = nodeSlots.getSlot(e.target);
+    int outIndex = e.outIndex;
+    int inIndex = e.inIndex;
+
+    releaseMaterial(e.material);
+    strings.release(e.label);
+    changeLog.record(ChangeLog::EDGE_REMOVED, edge, e.source, e.target);
+
+    AdjacencyList& outEdges = nodeVector.edit(sourceSlot).outEdges;
+    incidences.set(outEdges, outIndex, incidences.get(outEdges, outEdges.size - 1));
+    incidences.pop_back(outEdges);
+    if(outIndex < outEdges.size)
+    {
+        int moved = incidences.get(outEdges, outIndex).edge;
+        edgeVector.edit(edgeSlots.getSlot(moved)).outIndex = outIndex;
+    }
+
+    AdjacencyList& inEdges = nodeVector.edit(targetSlot).inEdges;
+    incidences.set(inEdges, inIndex, incidences.get(inEdges, inEdges.size - 1));
+    incidences.pop_back(inEdges);
+    if(inIndex < inEdges.size)
+    {
+        int moved = incidences.get(inEdges, inIndex).edge;
+        edgeVector.edit(edgeSlots.getSlot(moved)).inIndex = inIndex;
+    }
+
+    int slot = edgeSlots.erase(edge);
+    eraseSlot(edgeVector, slot);
+    edgeAttributes.eraseSlot(slot);
+}
+
+void Graph::findEdges(const string& key, const string& value, vector<int>& edges)
+{
+    lock();
+
+    edgeAttributes.find(key, value, edges);
+
+    for(int i = 0; i < (int)edges.size(); i++)
+    {
+        edges[i] = edgeSlots.getId(edges[i]);
+    }
+
+    unlock();
+}
+
+void Graph::findEdges(const string& key, double min, double max, vector<int>& edges)
+{
+    lock();
+
+    edgeAttributes.find(key, min, max, edges);
+
+    for(int i = 0; i < (int)edges.size(); i++)
+    {
+        edges[i] = edgeSlots.getId(edges[i]);
+    }
+
+    unlock();
+}
+
 const Edge& Graph::getEdge(int edge)
 {
-    return edgeMap[edge];
+    return edgeVector[edgeSlots.getSlot(edge)];
+}
+
+const Attributes Graph::getEdgeAttributes(int edge)
+{
+    Attributes attributes;
+
+    lock();
+    edgeAttributes.get(edgeSlots.getSlot(edge), attributes);
+    unlock();
+
+    return attributes;
 }
 
-const list<int>& Graph::getEdges(int source, int target)
+const vector<int> Graph::getEdges(int source, int target)
 {
-    if(hasEdge(source, target))
-        return nodeMap[source].adjacent[target];
+    vector<int> edges;
+
+    if(!isValidNode(source) || !isValidNode(target)) return edges;
+    flushIfBatching();
+
+    const AdjacencyList& outEdges = nodeVector[nodeSlots.getSlot(source)].outEdges;
 
-    return empty;
+    for(int index = 0; index < outEdges.size; index++)
+    {
+        const Incidence& i = incidences.get(outEdges, index);
+        if(i.node == target) edges.push_back(i.edge);
+    }
+
+    return edges;
 }
 
 const std::string& Graph::getEdgeLabel(int edge)
 {
-    return edgeMap[edge].label;
+    return strings.get(edgeVector[edgeSlots.getSlot(edge)].label);
 }
 
 const GLMaterial* Graph::getEdgeMaterial(int edge)
 {
-    return getEdgeMaterialFromId(edgeMap[edge].material);
+    return getEdgeMaterialFromId(edgeVector[edgeSlots.getSlot(edge)].material);
 }
 
 const float Graph::getEdgeWeight(int edge)
 {
-    return edgeMap[edge].weight;
+    return edgeVector[edgeSlots.getSlot(edge)].weight;
 }
 
-const set<int>& Graph::getEdges() const
+const vector<int>& Graph::getEdges() const
 {
-    return edges;
+    return edgeSlots.getIds();
 }
 
 const int Graph::getEdgeCount() const
 {
-    return (int)edges.size();
+    return edgeSlots.size();
 }
 
+// scans whichever of the two incidence lists is shorter
 const bool Graph::hasEdge(int source, int target)
 {
-    return nodeMap[source].adjacent.find(target) != nodeMap[source].adjacent.end();
+    if(!isValidNode(source) || !isValidNode(target)) return false;
+    flushIfBatching();
+
+    const AdjacencyList& outEdges = nodeVector[nodeSlots.getSlot(source)].outEdges;
+    const AdjacencyList& inEdges = nodeVector[nodeSlots.getSlot(target)].inEdges;
+
+    if(outEdges.size <= inEdges.size)
+    {
+        for(int index = 0; index < outEdges.size; index++)
+        {
+            if(incidences.get(outEdges, index).node == target) return true;
+        }
+    }
+    else
+    {
+        for(int index = 0; index < inEdges.size; index++)
+        {
+            if(incidences.get(inEdges, index).node == source) return true;
+        }
+    }
+
+    return false;
 }
 
 const bool Graph::isBidirectional(int edge)
 {
-    return isBidirectional(edgeMap[edge].source, edgeMap[edge].target);
+    const Edge& e = getEdge(edge);
+    return isBidirectional(e.source, e.target);
 }
 
 const bool Graph::isBidirectional(int source, int target)
@@ -368,52 +842,106 @@ const bool Graph::isBidirectional(int source, int target)
 
 const bool Graph::isValidEdge(int edge) const
 {
-    return edgeMap.find(edge) != edgeMap.end();
+    return edgeSlots.contains(edge);
 }
 
-void Graph::setEdgeColor(int edge, int r, int g, int b, int a)
+void Graph::setEdgeAttribute(int edge, const string& key, const string& value)
 {
-    setEdgeColor(edge, r / 255.0, g / 255.0, b / 255.0, a / 255.0);
+    lock();
+
+    if(!isValidEdge(edge))
+    {
+        unlock();
+        return;
+    }
+
+    edgeAttributes.set(edgeSlots.getSlot(edge), key, value);
+    styleVersion++;
+    changeLog.record(ChangeLog::EDGE_LABELED, edge);
+
+    unlock();
 }
 
-void Graph::setEdgeColor(int edge, double r, double g, double b, double a)
+void Graph::setEdgeAttribute(int edge, const string& key, double value)
 {
-    GLMaterial::Color c(r, g, b, a);
-    int materialId = -1;
+    lock();
 
-    // look for color in the cache
-    for(int i = 0; i < (int)materialVector.size(); i++)
+    if(!isValidEdge(edge))
     {
-        if(materialVector[i]->ambient == c)
-        {
-            materialId = i;
-            break;
-        }
+        unlock();
+        return;
     }
 
-    // if not found, add it
-    if(materialId == -1)
+    edgeAttributes.set(edgeSlots.getSlot(edge), key, value);
+    styleVersion++;
+    changeLog.record(ChangeLog::EDGE_LABELED, edge);
+
+    unlock();
+}
+
+void Graph::setEdgeColor(int edge, int r, int g, int b, int a)
+{
+    setEdgeColor(edge, r / 255.0, g / 255.0, b / 255.0, a / 255.0);
+}
+
+void Graph::setEdgeColor(int edge, double r, double g, double b, double a)
+{
+    lock();
+
+    if(!isValidEdge(edge))
     {
-        materialVector.push_back(new GLMaterial(c));
-        materialId = materialVector.size() - 1;
+        unlock();
+        return;
     }
 
-    edgeMap[edge].material = materialId;
+    Edge& e = edgeVector.edit(edgeSlots.getSlot(edge));
+    int materialId = editPalette().acquire(GLMaterial::Color(r, g, b, a));
+    releaseMaterial(e.material);
+    e.material = materialId;
+    styleVersion++;
+    changeLog.record(ChangeLog::EDGE_STYLED, edge);
 
+    unlock();
     update();
 }
 
 void Graph::setEdgeLabel(int edge, const std::string& label)
 {
-    edgeMap[edge].label = string(label);
+    lock();
 
+    if(!isValidEdge(edge))
+    {
+        unlock();
+        return;
+    }
+
+    int handle = strings.intern(label);
+    Edge& e = edgeVector.edit(edgeSlots.getSlot(edge));
+    strings.release(e.label);
+    e.label = handle;
+    styleVersion++;
+    changeLog.record(ChangeLog::EDGE_LABELED, edge);
+
+    unlock();
     update();
 }
 
 void Graph::setEdgeWeight(int edge, float weight)
 {
-    edgeMap[edge].weight = weight;
+    lock();
+
+    if(!isValidEdge(edge))
+    {
+        unlock();
+        return;
+    }
+
+    edgeVector.edit(edgeSlots.getSlot(edge)).weight = weight;
+    styleVersion++;
+    weightVersion++;
+    changeLog.record(ChangeLog::EDGE_STYLED, edge);
 
+    unlock();
     update();
 }
 
@@ -422,26 +950,43 @@ void Graph::setEdgeWeight(int edge, float weight)
  */
 const int Graph::addNode()
 {
-    mutex.lock();
+    lock();
 
-    Node n;
+    // New point should be inside the graph's bounds, or around the previous
+    // center if there are none yet. Points inside don't grow the bounds.
+    const BoundingSphere& b = getBounds(false);
+    Vrui::Point center = b.isEmpty() ? lastCenter : b.center;
+    Vrui::Scalar scale = max(b.radius, lastMaxDistance / 2); // effective radius
+    Vrui::Vector offset;
 
-    Vrui::Scalar scale = lastMaxDistance / 2; // effective radius
+    do
+    {
+        offset = Vrui::Vector(2 * VruiHelp::randomFloat() - 1,
+                              2 * VruiHelp::randomFloat() - 1,
+                              2 * VruiHelp::randomFloat() - 1);
+    }
+    while(Geometry::sqr(offset) > 1);
+
+    Vrui::Point position = center + offset * scale;
+    bounds.include(position);
+
+    int node = nodeSlots.insert();
+    nodeVector.push_back(Node());
+    positions.beginWrite();
+    positions.push_back(position);
+    positions.endWrite();
+    velocityVector.push_back(Vrui::Vector(0, 0, 0));
+    sizeVector.push_back(1);
+    nodeMaterialVector.push_back(MATERIAL_NODE_DEFAULT);
+    nodeAttributes.push_back();
+    topologyVersion++;
+    changeLog.record(ChangeLog::NODE_ADDED, node);
+
+    unlock();
+    update();
 
-    // New point should be around previous center of graph
-    n.position = Vrui::Point(lastCenter[0] + scale * (2 * VruiHelp::randomFloat() - 1),
-                             lastCenter[1] + scale * (2 * VruiHelp::randomFloat() - 1),
-                             lastCenter[2] + scale * (2 * VruiHelp::randomFloat() - 1) );
-
-    nodeId++;
-    nodes.insert(nodeId);
-    nodeMap[nodeId] = n;
-
-    mutex.unlock();
-    update();
-
-    return nodeId;
-}
+    return node;
+}
 
 const int Graph::addNode(const Vrui::Point& position)
 {
@@ -459,138 +1004,280 @@ const int Graph::addNode(const string& s)
 
 const int Graph::deleteNode()
 {
-    return deleteNode(*nodes.begin());
+    if(nodeSlots.size() == 0) return -1;
+
+    return deleteNode(nodeSlots.getId(0));
 }
 
 const int Graph::deleteNode(int node)
 {
-    mutex.lock();
+    lock();
 
     if(!isValidNode(node))
     {
-        mutex.unlock();
+        unlock();
         return -1;
     }
 
-    vector<int> killList(0);
+    int slot = nodeSlots.getSlot(node);
+    flushIfBatching();
 
-    foreach(int edge, edges)
+    // eraseEdge shrinks both lists, self loops included
+    while(nodeVector[slot].outEdges.size > 0)
     {
-        Edge& e = edgeMap[edge];
-
-        if(e.source == node || e.target == node)
-        {
-            killList.push_back(edge);
-        }
+        const AdjacencyList& outEdges = nodeVector[slot].outEdges;
+        eraseEdge(incidences.get(outEdges, outEdges.size - 1).edge);
     }
 
-    foreach(int edge, killList)
+    while(nodeVector[slot].inEdges.size > 0)
     {
-        edges.erase(edge);
-        edgeMap.erase(edge);
+        const AdjacencyList& inEdges = nodeVector[slot].inEdges;
+        eraseEdge(incidences.get(inEdges, inEdges.size - 1).edge);
     }
 
-    nodes.erase(node);
-    nodeMap.erase(node);
+    incidences.release(nodeVector.edit(slot).outEdges);
+    incidences.release(nodeVector.edit(slot).inEdges);
+    if(incidences.isFragmented()) compactIncidences();
 
-    mutex.unlock();
+    releaseMaterial(nodeMaterialVector[slot]);
+    strings.release(nodeVector[slot].label);
+    strings.release(nodeVector[slot].imagePath);
+
+    // the bounds still cover what's left, but may no longer touch it
+    if(Geometry::dist(positions[slot], bounds.center) > 0.9 * bounds.radius)
+    {
+        boundsTight = false;
+    }
+
+    nodeSlots.erase(node);
+    eraseSlot(nodeVector, slot);
+    positions.beginWrite();
+    positions.eraseSlot(slot);
+    positions.endWrite();
+    eraseSlot(velocityVector, slot);
+    eraseSlot(sizeVector, slot);
+    eraseSlot(nodeMaterialVector, slot);
+    nodeAttributes.eraseSlot(slot);
+    topologyVersion++;
+    changeLog.record(ChangeLog::NODE_REMOVED, node);
+
+    unlock();
     update();
 
     return node;
 }
 
-const Attributes& Graph::getNodeAttributes(int node)
+// Fills nodes with the nodes whose attribute equals value. Uses the column's
+// hash index if it has one, see addNodeAttribute().
+void Graph::findNodes(const string& key, const string& value, vector<int>& nodes)
+{
+    lock();
+
+    nodeAttributes.find(key, value, nodes);
+
+    for(int i = 0; i < (int)nodes.size(); i++)
+    {
+        nodes[i] = nodeSlots.getId(nodes[i]);
+    }
+
+    unlock();
+}
+
+// Fills nodes with the nodes whose numeric attribute is in [min, max]. Uses
+// the column's sorted index if it has one.
+void Graph::findNodes(const string& key, double min, double max, vector<int>& nodes)
+{
+    lock();
+
+    nodeAttributes.find(key, min, max, nodes);
+
+    for(int i = 0; i < (int)nodes.size(); i++)
+    {
+        nodes[i] = nodeSlots.getId(nodes[i]);
+    }
+
+    unlock();
+}
+
+// returns "" if the node has no such attribute
+const string Graph::getNodeAttribute(int node, const string& key)
+{
+    lock();
+
+    const AttributeColumn* column = nodeAttributes.findColumn(key);
+    string value = column && isValidNode(node) ? column->get(nodeSlots.getSlot(node)) : "";
+
+    unlock();
+
+    return value;
+}
+
+const Attributes Graph::getNodeAttributes(int node)
+{
+    Attributes attributes;
+
+    lock();
+    if(isValidNode(node)) nodeAttributes.get(nodeSlots.getSlot(node), attributes);
+    unlock();
+
+    return attributes;
+}
+
+// node's record, or a default one if node isn't a node
+const Node& Graph::findNode(int node) const
 {
-    return nodeMap[node].attributes;
+    return isValidNode(node) ? nodeVector[nodeSlots.getSlot(node)] : missingNode;
 }
 
 const int Graph::getNodeComponent(int node)
 {
-    return nodeMap[node].component;
+    return findNode(node).component;
 }
 
 const int Graph::getNodeDegree(int node)
 {
-    return nodeMap[node].inDegree + nodeMap[node].outDegree;
+    flushIfBatching();
+    const Node& n = findNode(node);
+    return n.inEdges.size + n.outEdges.size;
+}
+
+const int Graph::getNodeInDegree(int node)
+{
+    flushIfBatching();
+    return findNode(node).inEdges.size;
+}
+
+const int Graph::getNodeOutDegree(int node)
+{
+    flushIfBatching();
+    return findNode(node).outEdges.size;
 }
 
 const string& Graph::getNodeLabel(int node)
 {
-    return nodeMap[node].label;
+    return strings.get(findNode(node).label);
 }
 
 const GLMaterial* Graph::getNodeMaterial(int node)
 {
-    return getNodeMaterialFromId(nodeMap[node].material);
+    if(!isValidNode(node)) return getNodeMaterialFromId(MATERIAL_NODE_DEFAULT);
+
+    return getNodeMaterialFromId(nodeMaterialVector[nodeSlots.getSlot(node)]);
+}
+
+// The ids of node's out-neighbors, then its in-neighbors, and the weights of
+// the edges to them. A neighbor shows up once per edge. Threads other than the
+// one editing should hold lock() around this and what they do with the ids.
+void Graph::getNodeNeighbors(int node, vector<int>& neighbors, vector<float>& weights)
+{
+    neighbors.clear();
+    weights.clear();
+
+    if(!isValidNode(node)) return;
+    flushIfBatching();
+
+    const Node& n = nodeVector[nodeSlots.getSlot(node)];
+
+    for(int k = 0; k < n.outEdges.size; k++)
+    {
+        const Incidence& i = incidences.get(n.outEdges, k);
+        neighbors.push_back(i.node);
+        weights.push_back(edgeVector[edgeSlots.getSlot(i.edge)].weight);
+    }
+
+    for(int k = 0; k < n.inEdges.size; k++)
+    {
+        const Incidence& i = incidences.get(n.inEdges, k);
+        neighbors.push_back(i.node);
+        weights.push_back(edgeVector[edgeSlots.getSlot(i.edge)].weight);
+    }
 }
 
-const set<int>& Graph::getNodes() const
+const vector<int>& Graph::getNodes() const
 {
-    return nodes;
+    return nodeSlots.getIds();
 }
 
 const int Graph::getNodeCount() const
 {
-    return (int)nodes.size();
+    return nodeSlots.size();
 }
 
 const std::string& Graph::getNodeImagePath(int node)
 {
-    return nodeMap[node].imagePath;
+    return strings.get(findNode(node).imagePath);
 }
 
 const double Graph::getNodeImageScale(int node)
 {
-    return nodeMap[node].imageScale;
+    return findNode(node).imageScale;
 }
 
-const Vrui::Point& Graph::getNodePosition(int node)
+// safe against writers, but may be a step newer than the last read; the
+// origin if node isn't a node
+const Vrui::Point Graph::getNodePosition(int node)
 {
-    return nodeMap[node].position;
+    if(!isValidNode(node)) return Vrui::Point::origin;
+
+    return positions.get(nodeSlots.getSlot(node));
 }
 
 const float Graph::getNodeSize(int node)
 {
-    return nodeMap[node].size;
+    if(!isValidNode(node)) return 1;
+
+    return sizeVector[nodeSlots.getSlot(node)];
 }
 
-const std::string& Graph::getNodeType(int node)
+const NodeType Graph::getNodeType(int node)
 {
-    return nodeMap[node].type;
+    return findNode(node).type;
 }
 
-const Vrui::Point& Graph::getSourceNodePosition(int edge)
+const Vrui::Point Graph::getSourceNodePosition(int edge)
 {
-    return nodeMap[edgeMap[edge].source].position;
+    if(!isValidEdge(edge)) return Vrui::Point::origin;
+
+    return positions.get(nodeSlots.getSlot(getEdge(edge).source));
 }
 
-const Vrui::Point& Graph::getTargetNodePosition(int edge)
+const Vrui::Point Graph::getTargetNodePosition(int edge)
 {
-    return nodeMap[edgeMap[edge].target].position;
+    if(!isValidEdge(edge)) return Vrui::Point::origin;
+
+    return positions.get(nodeSlots.getSlot(getEdge(edge).target));
 }
 
 const Vrui::Vector& Graph::getNodeVelocity(int node)
 {
-    return nodeMap[node].velocity;
+    if(!isValidNode(node)) return missingVelocity;
+
+    return velocityVector[nodeSlots.getSlot(node)];
 }
 
 const bool Graph::isValidNode(int node) const
 {
-    return nodeMap.find(node) != nodeMap.end();
+    return nodeSlots.contains(node);
 }
 
 void Graph::moveNodes(const Vrui::Vector &offset)
 {
-    // Note: we don't lock.  The drawing methods work with a copy.
-    // And so what if the layout algorithm works with the old position
-    // for one more time step, assuming the main or RPC thread modifies it.
-    // It will get the new one at the update. Hopefully this causes no issues.
-    foreach(int node, nodes)
+    // The layout algorithm may still work with the old positions for one
+    // more time step. It will get the new ones at the update.
+    lock();
+
+    positions.beginWrite();
+    for(int slot = 0; slot < positions.size(); slot++)
     {
-        nodeMap[node].position += offset;
+        positions[slot] += offset;
     }
+    positions.endWrite();
     lastCenter += offset;
+    bounds.center += offset;
+    positionVersion++;
+    changeLog.record(ChangeLog::NODES_MOVED);
 
+    unlock();
     update();
 }
 
@@ -601,9 +1288,38 @@ void Graph::moveNodes(const Vrui::Point &offset)
 }
 
 
-void Graph::setNodeAttribute(int node, string& key, string& value)
+void Graph::setNodeAttribute(int node, const string& key, const string& value)
 {
-    nodeMap[node].attributes.push_back(pair<string, string>(key, value));
+    lock();
+
+    if(!isValidNode(node))
+    {
+        unlock();
+        return;
+    }
+
+    nodeAttributes.set(nodeSlots.getSlot(node), key, value);
+    styleVersion++;
+    changeLog.record(ChangeLog::NODE_LABELED, node);
+
+    unlock();
+}
+
+void Graph::setNodeAttribute(int node, const string& key, double value)
+{
+    lock();
+
+    if(!isValidNode(node))
+    {
+        unlock();
+        return;
+    }
+
+    nodeAttributes.set(nodeSlots.getSlot(node), key, value);
+    styleVersion++;
+    changeLog.record(ChangeLog::NODE_LABELED, node);
+
+    unlock();
 }
 
 void Graph::setNodeColor(int node, int r, int g, int b, int a)
@@ -613,180 +1329,688 @@ void Graph::setNodeColor(int node, int r, int g, int b, int a)
 
 void Graph::setNodeColor(int node, double r, double g, double b, double a)
 {
-    GLMaterial::Color c(r, g, b, a);
-    int materialId = -1;
-
-    // look for color in the cache
-    for(int i = 0; i < (int)materialVector.size(); i++)
-    {
-        if(materialVector[i]->ambient == c)
-        {
-            materialId = i;
-            break;
-        }
-    }
+    lock();
 
-    // if not found, add it
-    if(materialId == -1)
+    if(!isValidNode(node))
     {
-        materialVector.push_back(new GLMaterial(c));
-        materialId = materialVector.size() - 1;
+        unlock();
+        return;
     }
 
-    nodeMap[node].material = materialId;
+    int& material = nodeMaterialVector[nodeSlots.getSlot(node)];
+    int materialId = editPalette().acquire(GLMaterial::Color(r, g, b, a));
+    releaseMaterial(material);
+    material = materialId;
+    styleVersion++;
+    changeLog.record(ChangeLog::NODE_STYLED, node);
 
+    unlock();
     update();
 }
 
 void Graph::setNodeImagePath(int node, const string& imagePath)
 {
-    nodeMap[node].imagePath = imagePath;
+    lock();
+
+    if(!isValidNode(node))
+    {
+        unlock();
+        return;
+    }
 
+    int handle = strings.intern(imagePath);
+    Node& n = nodeVector.edit(nodeSlots.getSlot(node));
+    strings.release(n.imagePath);
+    n.imagePath = handle;
+    styleVersion++;
+    changeLog.record(ChangeLog::NODE_STYLED, node);
+
+    unlock();
     update();
 }
 
 void Graph::setNodeImageScale(int node, const double& scale)
 {
-    nodeMap[node].imageScale = scale;
+    lock();
+
+    if(!isValidNode(node))
+    {
+        unlock();
+        return;
+    }
 
+    nodeVector.edit(nodeSlots.getSlot(node)).imageScale = scale;
+    styleVersion++;
+    changeLog.record(ChangeLog::NODE_STYLED, node);
+
+    unlock();
     update();
 }
 
 void Graph::setNodeLabel(int node, const std::string& label)
 {
-    nodeMap[node].label = label;
+    lock();
+
+    if(!isValidNode(node))
+    {
+        unlock();
+        return;
+    }
 
+    int handle = strings.intern(label);
+    Node& n = nodeVector.edit(nodeSlots.getSlot(node));
+    strings.release(n.label);
+    n.label = handle;
+    styleVersion++;
+    changeLog.record(ChangeLog::NODE_LABELED, node);
+
+    unlock();
     update();
 }
 
 void Graph::setNodePosition(int node, const Vrui::Point& position)
 {
-    nodeMap[node].position = position;
+    lock();
+
+    if(!isValidNode(node))
+    {
+        unlock();
+        return;
+    }
 
+    int slot = nodeSlots.getSlot(node);
+    includeInBounds(slot, position);
+    positions.beginWrite();
+    positions[slot] = position;
+    positions.endWrite();
+    positionVersion++;
+    changeLog.record(ChangeLog::NODE_MOVED, node);
+
+    unlock();
     update();
 }
 
-void Graph::setNodeType(int node, const string& type)
+void Graph::setNodeType(int node, NodeType type)
 {
-    nodeMap[node].type = type;
+    lock();
+
+    if(!isValidNode(node))
+    {
+        unlock();
+        return;
+    }
 
+    nodeVector.edit(nodeSlots.getSlot(node)).type = type;
+    styleVersion++;
+    changeLog.record(ChangeLog::NODE_STYLED, node);
+
+    unlock();
     update();
 }
 
 void Graph::setNodeVelocity(int node, const Vrui::Vector& velocity)
 {
-    nodeMap[node].velocity = velocity;
+    lock();
+    if(isValidNode(node)) velocityVector[nodeSlots.getSlot(node)] = velocity;
+    unlock();
 }
 
 void Graph::setNodeSize(int node, float size)
 {
-    nodeMap[node].size = size;
+    lock();
+
+    if(!isValidNode(node))
+    {
+        unlock();
+        return;
+    }
 
+    sizeVector[nodeSlots.getSlot(node)] = size;
+    styleVersion++;
+    changeLog.record(ChangeLog::NODE_STYLED, node);
+
+    unlock();
     update();
 }
 
 void Graph::updateNodePosition(int node, const Vrui::Vector& delta)
 {
-    nodeMap[node].position += delta;
+    lock();
 
+    if(!isValidNode(node))
+    {
+        unlock();
+        return;
+    }
+
+    int slot = nodeSlots.getSlot(node);
+    includeInBounds(slot, positions[slot] + delta);
+    positions.beginWrite();
+    positions[slot] += delta;
+    positions.endWrite();
+    positionVersion++;
+    changeLog.record(ChangeLog::NODE_MOVED, node);
+
+    unlock();
+    update();
+}
+
+// moves nodes[i] by deltas[i], skipping nodes that have gone away since; the
+// bounds grow in place as for a single node
+void Graph::updateNodePositions(const vector<int>& nodes, const vector<Vrui::Vector>& deltas)
+{
+    lock();
+
+    positions.beginWrite();
+    for(int i = 0; i < (int)nodes.size(); i++)
+    {
+        if(!isValidNode(nodes[i])) continue;
+
+        int slot = nodeSlots.getSlot(nodes[i]);
+        includeInBounds(slot, positions[slot] + deltas[i]);
+        positions[slot] += deltas[i];
+        changeLog.record(ChangeLog::NODE_MOVED, nodes[i]);
+    }
+    positions.endWrite();
+    positionVersion++;
+
+    unlock();
     update();
 }
 
 // no update() needed
 void Graph::updateNodeVelocity(int node, const Vrui::Vector& delta)
 {
-    nodeMap[node].velocity += delta;
+    lock();
+    if(isValidNode(node)) velocityVector[nodeSlots.getSlot(node)] += delta;
+    unlock();
+}
+
+/*
+ * focus
+ */
+
+// The active nodes, cached until nodes are added or removed or the focus or
+// components change.
+boost::shared_ptr<const ActiveNodes> Graph::getActiveNodes()
+{
+    lock();
+    flushIfBatching();
+    boost::shared_ptr<const ActiveNodes> result = refreshActiveNodes();
+    unlock();
+
+    return result;
+}
+
+// Caller must hold the mutex, with the batch flushed.
+const boost::shared_ptr<const ActiveNodes>& Graph::refreshActiveNodes()
+{
+    if(!activeNodes || activeTopologyVersion != topologyVersion || activeFocusVersion != focusVersion)
+    {
+        ActiveNodes* a = new ActiveNodes();
+        a->all = focus == FOCUS_ALL;
+
+        if(a->all)
+        {
+            a->nodes = nodeSlots.getIds();
+            a->slots.resize(nodeSlots.size());
+
+            for(int slot = 0; slot < nodeSlots.size(); slot++)
+            {
+                a->slots[slot] = slot;
+            }
+        }
+        else
+        {
+            a->active.resize(nodeSlots.size(), false);
+
+            for(int slot = 0; slot < nodeSlots.size(); slot++)
+            {
+                if(nodeVector[slot].component == focus)
+                {
+                    a->nodes.push_back(nodeSlots.getId(slot));
+                    a->slots.push_back(slot);
+                    a->active[slot] = true;
+                }
+            }
+        }
+
+        activeNodes.reset(a);
+        activeTopologyVersion = topologyVersion;
+        activeFocusVersion = focusVersion;
+    }
+
+    return activeNodes;
+}
+
+// Fills edges with the ids of edges whose ends are both active, walking only
+// the active nodes' edges.
+void Graph::getActiveEdges(vector<int>& edges)
+{
+    lock();
+    flushIfBatching();
+
+    edges.clear();
+
+    const ActiveNodes& active = *refreshActiveNodes();
+
+    if(active.all)
+    {
+        edges = edgeSlots.getIds();
+    }
+    else
+    {
+        foreach(int slot, active.slots)
+        {
+            const AdjacencyList& outEdges = nodeVector[slot].outEdges;
+
+            for(int index = 0; index < outEdges.size; index++)
+            {
+                const Incidence& i = incidences.get(outEdges, index);
+
+                if(active.isActive(nodeSlots.getSlot(i.node)))
+                {
+                    edges.push_back(i.edge);
+                }
+            }
+        }
+    }
+
+    unlock();
+}
+
+const int Graph::getFocus() const
+{
+    return focus;
+}
+
+const bool Graph::isActiveNode(int node) const
+{
+    return focus == FOCUS_ALL || (isValidNode(node) && nodeVector[nodeSlots.getSlot(node)].component == focus);
+}
+
+// Limits layouts and drawing to one component, see setComponents(), or
+// lifts the limit with FOCUS_ALL.
+void Graph::setFocus(int component)
+{
+    lock();
+
+    if(component == focus)
+    {
+        unlock();
+        return;
+    }
+
+    focus = component;
+    focusVersion++;
+    styleVersion++;
+    changeLog.record(ChangeLog::NODES_STYLED);
+
+    unlock();
+    update();
+}
+
+/*
+ * attribute columns
+ */
+
+// Declares a node attribute's type before any values are set, and which of
+// AttributeColumn::INDEX_HASH and INDEX_SORTED it keeps. An existing column
+// keeps its type.
+void Graph::addNodeAttribute(const string& key, AttributeColumn::Type type, int indexes)
+{
+    lock();
+    nodeAttributes.addColumn(key, type, indexes);
+    unlock();
+}
+
+void Graph::addEdgeAttribute(const string& key, AttributeColumn::Type type, int indexes)
+{
+    lock();
+    edgeAttributes.addColumn(key, type, indexes);
+    unlock();
+}
+
+/*
+ * slots
+ */
+
+/*
+ * Returns the cached CSR view, building it first if nodes or edges were added
+ * or removed since the last call. A style change only refreshes the weights.
+ * Callers hold on to the pointer, so a rebuild never pulls it out from under
+ * a layout that is still walking the old one.
+ */
+boost::shared_ptr<const Adjacency> Graph::getAdjacency()
+{
+    lock();
+    flushIfBatching();
+    boost::shared_ptr<const Adjacency> result = refreshAdjacency();
+    unlock();
+
+    return result;
+}
+
+// Brings the cached CSR view up to date. Caller must hold the mutex, with
+// the batch flushed.
+const boost::shared_ptr<const Adjacency>& Graph::refreshAdjacency()
+{
+    if(!adjacency || adjacencyTopologyVersion != topologyVersion)
+    {
+        Adjacency* a = new Adjacency();
+        int nodeCount = nodeSlots.size();
+
+        a->nodes = nodeSlots.getIds();
+        a->offsets.resize(nodeCount + 1);
+        a->inOffsets.resize(nodeCount);
+        a->offsets[0] = 0;
+
+        for(int slot = 0; slot < nodeCount; slot++)
+        {
+            const Node& n = nodeVector[slot];
+            a->offsets[slot + 1] = a->offsets[slot] + n.outEdges.size + n.inEdges.size;
+        }
+
+        a->neighbors.resize(a->offsets[nodeCount]);
+        a->edges.resize(a->offsets[nodeCount]);
+        a->weights.resize(a->offsets[nodeCount]);
+
+        for(int slot = 0; slot < nodeCount; slot++)
+        {
+            const Node& n = nodeVector[slot];
+            int index = a->offsets[slot];
+
+            for(int k = 0; k < n.outEdges.size; k++)
+            {
+                const Incidence& i = incidences.get(n.outEdges, k);
+                a->neighbors[index] = nodeSlots.getSlot(i.node);
+                a->edges[index] = i.edge;
+                a->weights[index] = edgeVector[edgeSlots.getSlot(i.edge)].weight;
+                index++;
+            }
+
+            a->inOffsets[slot] = index;
+
+            for(int k = 0; k < n.inEdges.size; k++)
+            {
+                const Incidence& i = incidences.get(n.inEdges, k);
+                a->neighbors[index] = nodeSlots.getSlot(i.node);
+                a->edges[index] = i.edge;
+                a->weights[index] = edgeVector[edgeSlots.getSlot(i.edge)].weight;
+                index++;
+            }
+        }
+
+        a->topologyVersion = topologyVersion;
+        adjacency.reset(a);
+        adjacencyTopologyVersion = topologyVersion;
+        adjacencyWeightVersion = weightVersion;
+    }
+    else if(adjacencyWeightVersion != weightVersion)
+    {
+        Adjacency* a = new Adjacency(*adjacency);
+
+        for(int index = 0; index < (int)a->edges.size(); index++)
+        {
+            a->weights[index] = edgeVector[edgeSlots.getSlot(a->edges[index])].weight;
+        }
+
+        adjacency.reset(a);
+        adjacencyWeightVersion = weightVersion;
+    }
+
+    return adjacency;
+}
+
+const int Graph::getEdgeSlot(int edge) const
+{
+    return edgeSlots.getSlot(edge);
+}
+
+const int Graph::getNodeSlot(int node) const
+{
+    return nodeSlots.getSlot(node);
+}
+
+// a consistent copy of every position, indexed by slot, taken without locking
+void Graph::getNodePositions(vector<Vrui::Point>& copy) const
+{
+    positions.read(copy);
+}
+
+// copies, since nodes may come and go while a layout uses them
+void Graph::getNodeVelocities(vector<Vrui::Vector>& copy)
+{
+    lock();
+    copy.assign(velocityVector.begin(), velocityVector.end());
+    unlock();
+}
+
+void Graph::getNodeSizes(vector<float>& copy)
+{
+    lock();
+    copy.assign(sizeVector.begin(), sizeVector.end());
+    unlock();
+}
+
+const vector<int>& Graph::getNodeMaterials() const
+{
+    return nodeMaterialVector;
+}
+
+// deltas are indexed by slot, readers see all of them or none
+void Graph::updateNodePositions(const vector<Vrui::Vector>& deltas)
+{
+    lock();
+
+    positions.beginWrite();
+    for(int slot = 0; slot < (int)deltas.size() && slot < nodeSlots.size(); slot++)
+    {
+        positions[slot] += deltas[slot];
+    }
+    positions.endWrite();
+    positionVersion++;
+    changeLog.record(ChangeLog::NODES_MOVED);
+    boundsValid = false;
+
+    unlock();
+    update();
+}
+
+// no update() needed
+void Graph::updateNodeVelocities(const vector<Vrui::Vector>& deltas)
+{
+    lock();
+
+    for(int slot = 0; slot < (int)deltas.size() && slot < nodeSlots.size(); slot++)
+    {
+        velocityVector[slot] += deltas[slot];
+    }
+
+    unlock();
 }
 
 /*
  * boost wrappers
  */
-boost::BoostGraph Graph::toBoost()
+// maps a result indexed by slot onto node ids
+template <class T>
+static vector<T> bySlotToById(const Adjacency& a, const vector<T>& v, const T& missing)
 {
-    boost::BoostGraph g;
+    int bound = 0;
 
-    for(int node = 0; node > getNodeCount(); node++)
+    foreach(int node, a.nodes)
     {
-        boost::add_vertex(g);
+        bound = max(bound, node + 1);
     }
 
-    for(int edge = 0; edge < getEdgeCount(); edge++)
+    vector<T> result(bound, missing);
+
+    for(int slot = 0; slot < (int)a.nodes.size(); slot++)
     {
-        boost::add_edge(edgeMap[edge].source, edgeMap[edge].target, g);
+        result[a.nodes[slot]] = v[slot];
     }
 
-    return g;
+    return result;
 }
 
 // boost divides degree by 2, results won't match networkx python package
 // http://lists.boost.org/boost-users/2008/11/42161.php
 vector<double> Graph::getBetweennessCentrality()
 {
-    mutex.lock();
-
-    boost::BoostGraph g = toBoost();
-    vector<double> bc(getNodeCount());
+    boost::shared_ptr<const Adjacency> a = getAdjacency();
+    vector<double> bc(num_vertices(*a));
 
-    if(getNodeCount() == 0) return bc;
-    brandes_betweenness_centrality(g,
-            make_iterator_property_map(bc.begin(), boost::get(boost::vertex_index, g)));
+    if(bc.size() > 0)
+    {
+        boost::brandes_betweenness_centrality(*a,
+                boost::make_iterator_property_map(bc.begin(), get(boost::vertex_index, *a)));
+    }
 
-    mutex.unlock();
-    return bc;
+    return bySlotToById(*a, bc, 0.0);
 }
 
+// predecessors by id on the weighted shortest paths from the previous node,
+// nodes that can't be reached are their own predecessor
 vector<int> Graph::getShortestPath()
 {
-    mutex.lock();
+    boost::shared_ptr<const Adjacency> a = getAdjacency();
+    int nodeCount = num_vertices(*a);
+    int source = find(a->nodes.begin(), a->nodes.end(), application->getPreviousNode()) - a->nodes.begin();
+    vector<int> p(nodeCount);
+    vector<double> d(nodeCount);
 
-    boost::BoostGraph g = toBoost();
-    vector<int> p(getNodeCount());
-    vector<int> d(getNodeCount());
-
-    if(getNodeCount() == 0) return p;
-    dijkstra_shortest_paths(g,
-            application->getPreviousNode(),
-            &p[0],
-            &d[0],
-            boost::get(boost::edge_weight, g),
-            boost::get(boost::vertex_index, g),
-            std::less<int>(), // compare
-            boost::closed_plus<int>(), // combine
-            std::numeric_limits<int>::max(), // max dist
-            0, // zero dist
-            boost::default_dijkstra_visitor());
+    if(source == nodeCount) return vector<int>();
+    boost::dijkstra_shortest_paths(*a, source,
+            boost::predecessor_map(&p[0]).distance_map(&d[0]));
 
-    mutex.unlock();
-    return p;
+    for(int slot = 0; slot < nodeCount; slot++)
+    {
+        p[slot] = a->nodes[p[slot]];
+    }
+
+    return bySlotToById(*a, p, -1);
 }
 
+// predecessors by id in a minimum spanning tree, by edge weight
 vector<int> Graph::getSpanningTree()
 {
-    mutex.lock();
+    boost::shared_ptr<const Adjacency> a = getAdjacency();
+    int nodeCount = num_vertices(*a);
+    vector<int> p(nodeCount);
 
-    boost::BoostGraph g = toBoost();
-    vector<int> p(getNodeCount());
+    if(nodeCount == 0) return p;
+    boost::prim_minimum_spanning_tree(*a, &p[0]);
 
-    if(getNodeCount() == 0) return p;
-    prim_minimum_spanning_tree(g, &p[0]);
+    for(int slot = 0; slot < nodeCount; slot++)
+    {
+        p[slot] = a->nodes[p[slot]];
+    }
 
-    mutex.unlock();
-    return p;
+    return bySlotToById(*a, p, -1);
 }
 
+/*
+ * Labels every node with its connected component. If the graph has only
+ * grown since the last call, the new nodes and edges are merged into the
+ * existing components, relabeling the smaller side of each merge, so the
+ * work follows the change instead of the graph. Anything removed means
+ * starting over. The focus follows its nodes to their new component.
+ */
 void Graph::setComponents()
 {
-    mutex.lock();
+    lock();
+    flushIfBatching();
 
-    boost::BoostGraph g = toBoost();
-    vector<int> c(getNodeCount());
+    ChangeSet changes;
+    changeLog.getChanges(componentsVersion, changes);
 
-    connected_components(g, &c[0]);
-
-    foreach(int node, nodes)
+    if(componentsVersion >= 0 && !changes.reload && changes.removals == 0)
     {
-        nodeMap[node].component = c[node];
+        foreach(const Change& c, changes.structure)
+        {
+            if(c.kind == ChangeLog::NODE_ADDED)
+            {
+                nodeVector.edit(nodeSlots.getSlot(c.id)).component = componentMembers.size();
+                componentMembers.push_back(vector<int>(1, c.id));
+                changeLog.record(ChangeLog::NODE_STYLED, c.id);
+            }
+            else if(c.kind == ChangeLog::EDGE_ADDED)
+            {
+                int a = nodeVector[nodeSlots.getSlot(c.source)].component;
+                int b = nodeVector[nodeSlots.getSlot(c.target)].component;
+
+                if(a == b) continue;
+                if(componentMembers[a].size() < componentMembers[b].size()) std::swap(a, b);
+
+                // a's nodes join the focused ones, so they are all restyled
+                if(focus == b)
+                {
+                    focus = a;
+                    changeLog.record(ChangeLog::NODES_STYLED);
+                }
+
+                foreach(int node, componentMembers[b])
+                {
+                    nodeVector.edit(nodeSlots.getSlot(node)).component = a;
+                    changeLog.record(ChangeLog::NODE_STYLED, node);
+                }
+
+                componentMembers[a].insert(componentMembers[a].end(),
+                                           componentMembers[b].begin(), componentMembers[b].end());
+                componentMembers[b].clear();
+            }
+        }
     }
+    else
+    {
+        // a node of the focused component that is still around, if any
+        int focusNode = -1;
 
-    mutex.unlock();
+        if(focus >= 0 && focus < (int)componentMembers.size())
+        {
+            foreach(int node, componentMembers[focus])
+            {
+                if(isValidNode(node))
+                {
+                    focusNode = node;
+                    break;
+                }
+            }
+        }
+
+        const Adjacency& a = *refreshAdjacency();
+        vector<int> c(num_vertices(a));
+
+        if(c.size() > 0) boost::connected_components(a, &c[0]);
+
+        componentMembers.clear();
+
+        for(int slot = 0; slot < nodeSlots.size(); slot++)
+        {
+            int component = c[slot];
+
+            nodeVector.edit(slot).component = component;
+
+            if(component >= (int)componentMembers.size())
+            {
+                componentMembers.resize(component + 1);
+            }
+
+            componentMembers[component].push_back(nodeSlots.getId(slot));
+        }
+
+        // the numbers start over, so a focus whose nodes are gone is lifted
+        // rather than left on whatever component now has its number
+        if(focusNode >= 0) focus = nodeVector[nodeSlots.getSlot(focusNode)].component;
+        else if(focus >= 0) focus = FOCUS_ALL;
+
+        changeLog.record(ChangeLog::NODES_STYLED);
+    }
+
+    componentsVersion = changeLog.getVersion();
+    focusVersion++;
+    styleVersion++;
+
+    unlock();
 }
@@ -19,7 +19,16 @@
 #ifndef __GRAPH_HPP
 #define __GRAPH_HPP
 
+#include <adjacencypool.hpp>
+#include <attributestore.hpp>
+#include <boundingsphere.hpp>
+#include <changelog.hpp>
+#include <cowvector.hpp>
+#include <materialpalette.hpp>
 #include <mycelia.hpp>
+#include <positionbuffer.hpp>
+#include <slotmap.hpp>
+#include <stringtable.hpp>
 #include <vruihelp.hpp>
 
 #define MATERIAL_NODE_DEFAULT 0
@@ -28,48 +37,38 @@
 #define MATERIAL_SELECTED_PREVIOUS 3
 #define MATERIAL_HIGHLIGHTED 4
 
-namespace boost
-{
-typedef adjacency_list < vecS, vecS, undirectedS,
-        property<vertex_index_t, int>,
-        property<edge_weight_t, double> > BoostGraph;
-}
-
-typedef std::vector<std::pair<std::string, std::string> > Attributes;
+#define FOCUS_ALL -1
 
+/*
+ * Per-node data that is not touched by layouts or the render loop. Position,
+ * velocity, size and material live in Graph's slot-indexed arrays instead,
+ * and attributes in its nodeAttributes columns. Strings are handles into
+ * Graph's string table.
+ */
 class Node
 {
 public:
-    Vrui::Point position;
-    Vrui::Vector velocity;
-    std::tr1::unordered_map<int, std::list<int> > adjacent;
-
+    // Spans of Graph's adjacency pool. Degrees are the sizes of these lists,
+    // so they can't drift.
+    AdjacencyList outEdges;
+    AdjacencyList inEdges;
 
-    std::string label;
-    std::string type;
+    int label;
+    NodeType type;
 
-    // These are used if the type is "image".
-    std::string imagePath;
+    // These are used if the type is NODE_IMAGE.
+    int imagePath;
     double imageScale;
 
-    Attributes attributes;
-    float size;
     int component;
-    int inDegree;
-    int outDegree;
-    int material;
 
     Node()
+      : label(0),
+        type(NODE_SHAPE),
+        imagePath(0),
+        imageScale(1),
+        component(0)
     {
-        position = Vrui::Point(0, 0, 0);
-        velocity = Vrui::Vector(0, 0, 0);
-        type = "shape";
-        size = 1;
-        component = 0;
-        inDegree = 0;
-        outDegree = 0;
-        material = MATERIAL_NODE_DEFAULT;
-        imageScale = 1;
     }
 };
 
@@ -78,58 +77,172 @@ class Edge
 public:
     int source;
     int target;
-    std::string label;
+    int label; // handle into Graph's string table
     int material;
     float weight;
 
+    // positions in the source's outEdges and the target's inEdges
+    int outIndex;
+    int inIndex;
+
     Edge()
        : source(0),
          target(0),
+         label(0),
          material(MATERIAL_EDGE_DEFAULT),
-         weight(1)
+         weight(1),
+         outIndex(0),
+         inIndex(0)
     {
     }
 
     Edge(int s, int t)
       : source(s),
         target(t),
+        label(0),
         material(MATERIAL_EDGE_DEFAULT),
-        weight(1)
+        weight(1),
+        outIndex(0),
+        inIndex(0)
     {
     }
 };
 
+/*
+ * Compressed sparse row view of the graph, indexed by node slot. Slot s has
+ * its out-neighbors at [offsets[s], inOffsets[s]) and its in-neighbors at
+ * [inOffsets[s], offsets[s + 1]) in neighbors, edges and weights. Every edge
+ * shows up once under each of its ends.
+ */
+class Adjacency
+{
+public:
+    std::vector<int> nodes;     // ids
+    std::vector<int> offsets;   // node count + 1 entries
+    std::vector<int> inOffsets; // node count entries
+    std::vector<int> neighbors; // slots
+    std::vector<int> edges;     // ids
+    std::vector<float> weights;
+    int topologyVersion;        // the graph's, when this was built
+
+    const int getDegree(int slot) const
+    {
+        return offsets[slot + 1] - offsets[slot];
+    }
+};
+
+/*
+ * The nodes that layouts and drawing work on: all of them, or only those in
+ * the focused component, see Graph::setFocus(). nodes and slots list the same
+ * nodes in the same order.
+ */
+class ActiveNodes
+{
+public:
+    bool all;
+    std::vector<int> nodes;   // ids
+    std::vector<int> slots;
+    std::vector<bool> active; // by slot
+
+    const bool isActive(int slot) const
+    {
+        return all || (slot < (int)active.size() && active[slot]);
+    }
+};
+
 class Graph
 {
 private:
     Mycelia* application;
 
-    std::tr1::unordered_map<int, Node> nodeMap;
-    std::set<int> nodes;
-    int nodeId;
+    // nodes -- everything below is indexed by slot, see SlotMap
+    SlotMap nodeSlots;
+    CowVector<Node> nodeVector;
+    PositionBuffer positions;
+    std::vector<Vrui::Vector> velocityVector;
+    std::vector<float> sizeVector;
+    std::vector<int> nodeMaterialVector;
+    AttributeStore nodeAttributes;
+
+    // edges -- indexed by slot
+    SlotMap edgeSlots;
+    CowVector<Edge> edgeVector;
+    AdjacencyPool incidences; // holds every Node's outEdges and inEdges
+    AttributeStore edgeAttributes;
 
-    std::tr1::unordered_map<int, Edge> edgeMap;
-    std::set<int> edges;
-    int edgeId;
+    // shared with snapshots, cloned by the first edit after one is taken
+    boost::shared_ptr<MaterialPalette> palette;
 
-    /** This needs to be moved to dataItem, or Graph should derive from GLObject */
-    std::vector<GLMaterial*> materialVector;
+    // labels and image paths of nodes and edges
+    StringTable strings;
 
     std::string textureNodeMode;
 
     Vrui::Point lastCenter;
     Vrui::Scalar lastMaxDistance;
 
+    // Covers every node while boundsValid. Single node changes grow it in
+    // place; moving every node at once clears boundsValid and getBounds()
+    // refits it. boundsTight is cleared once a node on the surface moves
+    // inward or goes away, which leaves the sphere larger than it needs to be.
+    BoundingSphere bounds;
+    bool boundsValid;
+    bool boundsTight;
+
+    // Bumped under the mutex by every change, so acquireSnapshot() can tell
+    // which parts of a snapshot are stale. version covers all of them.
     int version;
+    int topologyVersion; // node or edge added or removed
+    int styleVersion;    // labels, colors, sizes, attributes, components
+    int weightVersion;   // edge weights, which bump styleVersion as well
+    int positionVersion;
     Threads::Mutex mutex;
 
-    const std::list<int> empty; // returned by getEdges when none exist
+    // every change in order, see getChanges()
+    ChangeLog changeLog;
+
+    std::vector<Vrui::Point> positionScratch; // acquireSnapshot() copies through it
+
+    // rebuilt by getAdjacency() once topologyVersion moves on, its weights
+    // once weightVersion does
+    boost::shared_ptr<const Adjacency> adjacency;
+    int adjacencyTopologyVersion;
+    int adjacencyWeightVersion;
+
+    // the focused component or FOCUS_ALL, and the nodes it selects; rebuilt by
+    // getActiveNodes() once topologyVersion or focusVersion moves on
+    int focus;
+    int focusVersion;
+    boost::shared_ptr<const ActiveNodes> activeNodes;
+    int activeTopologyVersion;
+    int activeFocusVersion;
+
+    // see beginBatch(), which thread owns a batch is thread-local in graph.cpp
+    std::vector<int> pendingEdges; // added in this batch, not in incidence lists yet
+
+    // node ids by component, kept by setComponents() while the graph only grows
+    std::vector<std::vector<int> > componentMembers;
+    int componentsVersion;
+
+    void compactIncidences();
+    const Node& findNode(int) const;
+    const boost::shared_ptr<const Adjacency>& refreshAdjacency();
+    const boost::shared_ptr<const ActiveNodes>& refreshActiveNodes();
+    const BoundingSphere& getBounds(bool);
+    void includeInBounds(int, const Vrui::Point&);
+    void eraseEdge(int);
+    void flushEdges();
+    void flushIfBatching();
+    const bool isBatchOwner() const;
+    MaterialPalette& editPalette();
+    void releaseMaterial(int);
 
 public:
     Graph(Mycelia*);
     Graph& operator=(const Graph&);
 
     // general
+    void acquireSnapshot(Graph&);
     void clear();
     void clearVelocities();
     void init();
@@ -137,22 +250,33 @@ public:
     const GLMaterial* getEdgeMaterialFromId(int);
     const GLMaterial* getNodeMaterialFromId(int);
     const std::string& getTextureNodeMode() const;
+    const long getAdjacencyBytes() const;
+    const int getChanges(int, ChangeSet&);
     const int getVersion() const;
+    const int getTopologyVersion();
     void randomizePositions(Vrui::Scalar);
 
+    void redraw();
     void setTextureNodeMode(std::string&);
     void update();
     void write(const char*);
-    void lock() { mutex.lock(); }
-    void unlock() { mutex.unlock(); }
+    void lock();
+    void unlock();
+
+    // batches
+    void beginBatch(int = 0, int = 0);
+    void commit();
 
     // edges
     const int addEdge(int, int);
     void clearEdges();
     const int deleteEdge(int);
+    void findEdges(const std::string&, const std::string&, std::vector<int>&);
+    void findEdges(const std::string&, double, double, std::vector<int>&);
     const Edge& getEdge(int);
-    const std::set<int>& getEdges() const;
-    const std::list<int>& getEdges(int, int);
+    const Attributes getEdgeAttributes(int);
+    const std::vector<int>& getEdges() const;
+    const std::vector<int> getEdges(int, int);
     const int getEdgeCount() const;
     const GLMaterial* getEdgeMaterial(int);
     const std::string& getEdgeLabel(int);
@@ -161,6 +285,8 @@ public:
     const bool isBidirectional(int);
     const bool isBidirectional(int, int);
     const bool isValidEdge(int) const;
+    void setEdgeAttribute(int, const std::string&, const std::string&);
+    void setEdgeAttribute(int, const std::string&, double);
     void setEdgeColor(int, int, int, int, int = 255.0);
     void setEdgeColor(int, double, double, double, double = 1.0);
     void setEdgeLabel(int, const std::string&);
@@ -172,39 +298,68 @@ public:
     const int addNode(const std::string&);
     const int deleteNode();
     const int deleteNode(int);
-    const Attributes& getNodeAttributes(int);
+    void findNodes(const std::string&, const std::string&, std::vector<int>&);
+    void findNodes(const std::string&, double, double, std::vector<int>&);
+    const std::string getNodeAttribute(int, const std::string&);
+    const Attributes getNodeAttributes(int);
     const int getNodeComponent(int);
     const int getNodeDegree(int);
+    const int getNodeInDegree(int);
+    const int getNodeOutDegree(int);
     const std::string& getNodeLabel(int);
-    const std::set<int>& getNodes() const;
+    const std::vector<int>& getNodes() const;
     const int getNodeCount() const;
     const std::string& getNodeImagePath(int);
     const double getNodeImageScale(int);
     const GLMaterial* getNodeMaterial(int);
-    const Vrui::Point& getNodePosition(int);
+    void getNodeNeighbors(int, std::vector<int>&, std::vector<float>&);
+    const Vrui::Point getNodePosition(int);
     const Vrui::Vector& getNodeVelocity(int);
     const float getNodeSize(int);
-    const std::string& getNodeType(int);
-    const Vrui::Point& getSourceNodePosition(int);
-    const Vrui::Point& getTargetNodePosition(int);
+    const NodeType getNodeType(int);
+    const Vrui::Point getSourceNodePosition(int);
+    const Vrui::Point getTargetNodePosition(int);
     const bool isValidNode(int) const;
     void moveNodes(const Vrui::Vector&);
     void moveNodes(const Vrui::Point&);
-    void setNodeAttribute(int, std::string&, std::string&);
+    void setNodeAttribute(int, const std::string&, const std::string&);
+    void setNodeAttribute(int, const std::string&, double);
     void setNodeColor(int, int, int, int, int = 255.0);
     void setNodeColor(int, double, double, double, double = 1.0);
     void setNodeImagePath(int, const std::string&);
     void setNodeImageScale(int, const double&);    
     void setNodeLabel(int, const std::string&);
     void setNodePosition(int, const Vrui::Point&);
-    void setNodeType(int, const std::string&);
+    void setNodeType(int, NodeType);
     void setNodeVelocity(int, const Vrui::Vector&);
     void setNodeSize(int, float);
     void updateNodePosition(int, const Vrui::Vector&);
+    void updateNodePositions(const std::vector<int>&, const std::vector<Vrui::Vector>&);
     void updateNodeVelocity(int, const Vrui::Vector&);
 
-    // boost wrappers
-    boost::BoostGraph toBoost();
+    // focus
+    boost::shared_ptr<const ActiveNodes> getActiveNodes();
+    void getActiveEdges(std::vector<int>&);
+    const int getFocus() const;
+    const bool isActiveNode(int) const;
+    void setFocus(int);
+
+    // attribute columns -- declare a type and indexes ahead of the values
+    void addEdgeAttribute(const std::string&, AttributeColumn::Type, int = AttributeColumn::INDEX_NONE);
+    void addNodeAttribute(const std::string&, AttributeColumn::Type, int = AttributeColumn::INDEX_NONE);
+
+    // slots -- getNodes()[slot] and getEdges()[slot] map slots back to ids
+    boost::shared_ptr<const Adjacency> getAdjacency();
+    const int getEdgeSlot(int) const;
+    const int getNodeSlot(int) const;
+    void getNodePositions(std::vector<Vrui::Point>&) const;
+    void getNodeVelocities(std::vector<Vrui::Vector>&);
+    void getNodeSizes(std::vector<float>&);
+    const std::vector<int>& getNodeMaterials() const;
+    void updateNodePositions(const std::vector<Vrui::Vector>&);
+    void updateNodeVelocities(const std::vector<Vrui::Vector>&);
+
+    // boost wrappers, see graphtraits.hpp
     std::vector<double> getBetweennessCentrality();
     std::vector<int> getShortestPath();
     std::vector<int> getSpanningTree();
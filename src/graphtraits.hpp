@@ -0,0 +1,326 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GRAPHTRAITS_HPP
+#define __GRAPHTRAITS_HPP
+
+#include <graph.hpp>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+
+/*
+ * Boost Graph Library adapter for Adjacency, Graph's CSR view, so the boost
+ * algorithms run on Graph::getAdjacency() without copying it into an
+ * adjacency_list. Vertices are node slots and the graph is undirected: every
+ * edge is listed under both of its ends, so out_edges() walks all of them.
+ * An edge descriptor is one of those listings, and the two listings of an
+ * edge don't compare equal. Edge weights come from Edge::weight.
+ */
+
+class AdjacencyEdge
+{
+public:
+    int source; // slots
+    int target;
+    int index;  // into the Adjacency arrays
+
+    AdjacencyEdge()
+      : source(-1),
+        target(-1),
+        index(-1)
+    {
+    }
+
+    AdjacencyEdge(int source, int target, int index)
+      : source(source),
+        target(target),
+        index(index)
+    {
+    }
+
+    bool operator==(const AdjacencyEdge& e) const
+    {
+        return index == e.index;
+    }
+
+    bool operator!=(const AdjacencyEdge& e) const
+    {
+        return index != e.index;
+    }
+};
+
+class AdjacencyOutEdgeIterator
+    : public boost::iterator_facade<AdjacencyOutEdgeIterator,
+                                    AdjacencyEdge,
+                                    boost::random_access_traversal_tag,
+                                    AdjacencyEdge>
+{
+private:
+    friend class boost::iterator_core_access;
+
+    const Adjacency* adjacency;
+    int source;
+    int index;
+
+    AdjacencyEdge dereference() const
+    {
+        return AdjacencyEdge(source, adjacency->neighbors[index], index);
+    }
+
+    bool equal(const AdjacencyOutEdgeIterator& i) const
+    {
+        return index == i.index;
+    }
+
+    void increment() { index++; }
+    void decrement() { index--; }
+    void advance(std::ptrdiff_t n) { index += n; }
+
+    std::ptrdiff_t distance_to(const AdjacencyOutEdgeIterator& i) const
+    {
+        return i.index - index;
+    }
+
+public:
+    AdjacencyOutEdgeIterator()
+      : adjacency(0),
+        source(-1),
+        index(-1)
+    {
+    }
+
+    AdjacencyOutEdgeIterator(const Adjacency* adjacency, int source, int index)
+      : adjacency(adjacency),
+        source(source),
+        index(index)
+    {
+    }
+};
+
+// every edge once, from its source's side
+class AdjacencyEdgeIterator
+    : public boost::iterator_facade<AdjacencyEdgeIterator,
+                                    AdjacencyEdge,
+                                    boost::forward_traversal_tag,
+                                    AdjacencyEdge>
+{
+private:
+    friend class boost::iterator_core_access;
+
+    const Adjacency* adjacency;
+    int source;
+    int index;
+
+    AdjacencyEdge dereference() const
+    {
+        return AdjacencyEdge(source, adjacency->neighbors[index], index);
+    }
+
+    bool equal(const AdjacencyEdgeIterator& i) const
+    {
+        return source == i.source && index == i.index;
+    }
+
+    // moves on to the next slot with out-edges left, or one past the last
+    void skipEmpty()
+    {
+        int nodeCount = adjacency->inOffsets.size();
+
+        while(source < nodeCount && index == adjacency->inOffsets[source])
+        {
+            source++;
+            index = source < nodeCount ? adjacency->offsets[source] : 0;
+        }
+    }
+
+    void increment()
+    {
+        index++;
+        skipEmpty();
+    }
+
+public:
+    AdjacencyEdgeIterator()
+      : adjacency(0),
+        source(-1),
+        index(-1)
+    {
+    }
+
+    AdjacencyEdgeIterator(const Adjacency* adjacency, int source)
+      : adjacency(adjacency),
+        source(source),
+        index(source < (int)adjacency->inOffsets.size() ? adjacency->offsets[source] : 0)
+    {
+        skipEmpty();
+    }
+};
+
+// Edge::weight by descriptor
+class AdjacencyWeightMap
+{
+public:
+    typedef AdjacencyEdge key_type;
+    typedef float value_type;
+    typedef float reference;
+    typedef boost::readable_property_map_tag category;
+
+    const Adjacency* adjacency;
+
+    AdjacencyWeightMap(const Adjacency* adjacency = 0)
+      : adjacency(adjacency)
+    {
+    }
+};
+
+inline float get(const AdjacencyWeightMap& map, const AdjacencyEdge& e)
+{
+    return map.adjacency->weights[e.index];
+}
+
+/*
+ * Node positions by slot, e.g. from Graph::getNodePositions(), for
+ * algorithms that take a position map.
+ */
+typedef boost::iterator_property_map<std::vector<Vrui::Point>::iterator,
+                                     boost::identity_property_map> PositionMap;
+
+inline PositionMap makePositionMap(std::vector<Vrui::Point>& positions)
+{
+    return PositionMap(positions.begin(), boost::identity_property_map());
+}
+
+namespace boost
+{
+
+struct adjacency_traversal_tag
+    : public vertex_list_graph_tag,
+      public incidence_graph_tag,
+      public edge_list_graph_tag
+{
+};
+
+template <>
+struct graph_traits<Adjacency>
+{
+    typedef int vertex_descriptor;
+    typedef AdjacencyEdge edge_descriptor;
+    typedef undirected_tag directed_category;
+    typedef allow_parallel_edge_tag edge_parallel_category;
+    typedef adjacency_traversal_tag traversal_category;
+
+    typedef counting_iterator<int> vertex_iterator;
+    typedef AdjacencyOutEdgeIterator out_edge_iterator;
+    typedef void in_edge_iterator;
+    typedef AdjacencyEdgeIterator edge_iterator;
+    typedef void adjacency_iterator;
+
+    typedef int vertices_size_type;
+    typedef int edges_size_type;
+    typedef int degree_size_type;
+
+    static vertex_descriptor null_vertex()
+    {
+        return -1;
+    }
+};
+
+template <>
+struct graph_traits<const Adjacency> : public graph_traits<Adjacency>
+{
+};
+
+template <>
+struct property_map<Adjacency, vertex_index_t>
+{
+    typedef identity_property_map type;
+    typedef identity_property_map const_type;
+};
+
+template <>
+struct property_map<Adjacency, edge_weight_t>
+{
+    typedef AdjacencyWeightMap type;
+    typedef AdjacencyWeightMap const_type;
+};
+
+template <class Tag>
+struct property_map<const Adjacency, Tag> : public property_map<Adjacency, Tag>
+{
+};
+
+}
+
+inline std::pair<boost::counting_iterator<int>, boost::counting_iterator<int> >
+vertices(const Adjacency& a)
+{
+    return std::make_pair(boost::counting_iterator<int>(0),
+                          boost::counting_iterator<int>(a.offsets.size() - 1));
+}
+
+inline int num_vertices(const Adjacency& a)
+{
+    return a.offsets.size() - 1;
+}
+
+inline std::pair<AdjacencyOutEdgeIterator, AdjacencyOutEdgeIterator>
+out_edges(int slot, const Adjacency& a)
+{
+    return std::make_pair(AdjacencyOutEdgeIterator(&a, slot, a.offsets[slot]),
+                          AdjacencyOutEdgeIterator(&a, slot, a.offsets[slot + 1]));
+}
+
+inline std::pair<AdjacencyEdgeIterator, AdjacencyEdgeIterator> edges(const Adjacency& a)
+{
+    return std::make_pair(AdjacencyEdgeIterator(&a, 0),
+                          AdjacencyEdgeIterator(&a, a.inOffsets.size()));
+}
+
+inline int num_edges(const Adjacency& a)
+{
+    return a.neighbors.size() / 2;
+}
+
+inline int out_degree(int slot, const Adjacency& a)
+{
+    return a.getDegree(slot);
+}
+
+inline int source(const AdjacencyEdge& e, const Adjacency&)
+{
+    return e.source;
+}
+
+inline int target(const AdjacencyEdge& e, const Adjacency&)
+{
+    return e.target;
+}
+
+inline boost::identity_property_map get(boost::vertex_index_t, const Adjacency&)
+{
+    return boost::identity_property_map();
+}
+
+inline AdjacencyWeightMap get(boost::edge_weight_t, const Adjacency& a)
+{
+    return AdjacencyWeightMap(&a);
+}
+
+#endif
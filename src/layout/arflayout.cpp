@@ -39,6 +39,8 @@ ArfLayout::ArfLayout(Mycelia* application)
     connectedSpringLength = 1;
     stronglyConnectedSpringLength = 1;
     unconnectedSpringLength = 1;
+    
+    openingAngle = 1;
 }
 
 inline double ArfLayout::getSpringConstant(int edgeCount) const
@@ -88,59 +90,175 @@ void* ArfLayout::layout()
         //application->g->unlock();
     }
     
+    octree.clear();
+    adjacency.reset();
+    active.reset();
     return 0;
 }
 
+/*
+ * Gathers the cells and nodes one node feels the unconnected force from, a far
+ * octree cell counting as all of its nodes at its centroid.
+ */
+class ArfInteractions
+{
+public:
+    PackedPoints* points;
+    
+    void operator()(const Vrui::Point& centroid, Vrui::Scalar count, const Vrui::Point&, Vrui::Scalar)
+    {
+        points->push_back(centroid, count);
+    }
+};
+
+/*
+ * Each node feels the unconnected force from every other node through the
+ * octree, plus the difference a (strongly) connected spring makes for each of
+ * its neighbors. The old loop integrated once per pair, so the step grew with
+ * the node count and blew up past a few thousand nodes. This averages the
+ * pairs instead and takes at most MAX_STEPS steps with the result, which is
+ * the same to first order on smaller graphs and doesn't depend on the order
+ * of the nodes.
+ */
 void ArfLayout::layoutStep()
 {
-    int nodeCount = application->g->getNodeCount();
-    vector<Vrui::Vector> velocityVector(nodeCount);
-    vector<Vrui::Vector> positionVector(nodeCount);
+    Graph* g = application->g;
+    active = g->getActiveNodes();
+    adjacency = g->getAdjacency();
+    g->getNodePositions(positions);
+    g->getNodeVelocities(velocities);
+    g->getNodeSizes(sizes);
+    
+    // each copy was taken on its own, nodes may have come or gone in between
+    int nodeCount = std::min(std::min(velocities.size(), sizes.size()), std::min(positions.size(), adjacency->inOffsets.size()));
+    velocityVector.assign(nodeCount, Vrui::Vector(0, 0, 0));
+    positionVector.assign(nodeCount, Vrui::Vector(0, 0, 0));
+    
+    int selectedNode = application->getSelectedNode();
+    selectedSlot = g->isValidNode(selectedNode) ? g->getNodeSlot(selectedNode) : -1;
+    
+    // only the active nodes take part, the rest keep still
+    slots.clear();
+    foreach(int slot, active->slots)
+    {
+        if(slot < nodeCount) slots.push_back(slot);
+    }
+    
+    if(slots.size() < 2)
+    {
+        return;
+    }
+    
+    octree.build(positions, slots, vector<Vrui::Scalar>());
+    forceEngine.run(*this, slots.size());
+    
+    if(stopped)
+    {
+        return;
+    }
+    
+    g->updateNodeVelocities(velocityVector);
+    g->updateNodePositions(positionVector);
+}
+
+// one set of marks per worker, left all -1 by computeForces()
+void ArfLayout::setWorkerCount(int workers)
+{
+    int nodeCount = velocityVector.size();
+    outMarks.resize(workers);
+    inMarks.resize(workers);
+    interactions.resize(workers);
+    
+    for(int i = 0; i < workers; i++)
+    {
+        if((int)outMarks[i].size() != nodeCount) outMarks[i].assign(nodeCount, -1);
+        if((int)inMarks[i].size() != nodeCount) inMarks[i].assign(nodeCount, -1);
+    }
+}
+
+// moves slots[first, last), each on its own so ranges can run in parallel
+void ArfLayout::computeForces(int first, int last, int worker)
+{
+    vector<int>& outMark = outMarks[worker];
+    vector<int>& inMark = inMarks[worker];
+    
+    double pairs = slots.size() - 1;
+    double steps = std::min(pairs, (double)MAX_STEPS);
+    int nodeCount = velocityVector.size();
+    double repulsion = layoutRadius * sqrt(nodeCount);
+    ArfInteractions visitor;
+    visitor.points = &interactions[worker];
     
-    foreach(int source, application->g->getNodes())
+    for(int i = first; i < last; i++)
     {
-        if(!application->isSelectedComponent(source) || source == application->getSelectedNode())
+        int source = slots[i];
+        
+        if(stopped)
+        {
+            return;
+        }
+        
+        if(source == selectedSlot)
         {
             continue;
         }
         
-        double mass = application->g->getNodeSize(source); // treat size as mass
-        Vrui::Vector velocity = application->g->getNodeVelocity(source);
+        double mass = sizes[source]; // treat size as mass
+        Vrui::Vector velocity = velocities[source];
         Vrui::Vector dampingForce = dampingConstant * velocity;
         
-        foreach(int target, application->g->getNodes())
+        // an unconnected spring and repulsion from every other node
+        visitor.points->clear();
+        octree.visit(positions[source], source, openingAngle, visitor);
+        Vrui::Vector force = PackedForces::arf(positions[source], *visitor.points, unconnectedSpringConstant, unconnectedSpringLength, repulsion, 1 + beta);
+        
+        // neighbors past nodeCount were added after the positions were read
+        for(int index = adjacency->offsets[source]; index < adjacency->offsets[source + 1]; index++)
         {
-            if(stopped)
+            int target = adjacency->neighbors[index];
+            
+            if(target >= nodeCount)
             {
-                return;
+                continue;
             }
             
-            if(!application->isSelectedComponent(target) || source == target)
+            vector<int>& mark = index < adjacency->inOffsets[source] ? outMark : inMark;
+            mark[target] = source;
+        }
+        
+        // swap the unconnected spring for the right one, once per neighbor
+        for(int index = adjacency->offsets[source]; index < adjacency->offsets[source + 1]; index++)
+        {
+            int target = adjacency->neighbors[index];
+            
+            if(target >= nodeCount)
             {
                 continue;
             }
             
-            Vrui::Vector v = application->g->getNodePosition(source) - application->g->getNodePosition(target);
-            Vrui::Scalar mag = Geometry::mag(v);
+            int edgeCount = (int)(outMark[target] == source) + (int)(inMark[target] == source);
+            outMark[target] = inMark[target] = -1;
             
-            int edgeCount = (int)application->g->hasEdge(source, target) + (int)application->g->hasEdge(target, source);
-            double springConstant = getSpringConstant(edgeCount);
-            double springLength = getSpringLength(edgeCount);
+            if(target == source || edgeCount == 0 || !active->isActive(target))
+            {
+                continue;
+            }
             
-            double constA = springConstant * (mag - springLength) / mag;
-            Vrui::Vector springForce = constA * v;
+            Vrui::Vector v = positions[source] - positions[target];
+            Vrui::Scalar mag = Geometry::mag(v);
             
-            double constB = layoutRadius * sqrt(nodeCount) / pow(mag, 1 + beta);
-            Vrui::Vector repulsionForce = constB * v;
-
-            velocityVector[source] = VruiHelp::rk4(velocityVector[source], (dampingForce + springForce + repulsionForce) / mass, deltaTime);
-            positionVector[source] = VruiHelp::rk4(positionVector[source], velocity, deltaTime);
+            if(mag == 0)
+            {
+                continue;
+            }
+            
+            double springForce = getSpringConstant(edgeCount) * (mag - getSpringLength(edgeCount));
+            double unconnectedForce = unconnectedSpringConstant * (mag - unconnectedSpringLength);
+            force += v * ((springForce - unconnectedForce) / mag);
         }
-    }
-    
-    foreach(int node, application->g->getNodes())
-    {
-        application->g->updateNodeVelocity(node, velocityVector[node]);
-        application->g->updateNodePosition(node, positionVector[node]);
+        
+        force = dampingForce + force / pairs;
+        velocityVector[source] = VruiHelp::rk4(Vrui::Vector(0, 0, 0), force / mass, deltaTime) * steps;
+        positionVector[source] = VruiHelp::rk4(Vrui::Vector(0, 0, 0), velocity, deltaTime) * steps;
     }
 }
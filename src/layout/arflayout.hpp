@@ -24,8 +24,12 @@
 #include <graph.hpp>
 #include <mycelia.hpp>
 #include <layout/graphlayout.hpp>
+#include <layout/octree.hpp>
+#include <layout/packedforces.hpp>
 
-class ArfLayout : public GraphLayout
+#define MAX_STEPS 300
+
+class ArfLayout : public GraphLayout, public ForceKernel
 {
     friend class ArfWindow;
     
@@ -43,11 +47,34 @@ private:
     double stronglyConnectedSpringLength;
     double unconnectedSpringLength;
     
+    // far nodes are summed per octree cell, see Octree
+    double openingAngle;
+    Octree octree;
+    
+    // the step being computed, indexed by slot
+    boost::shared_ptr<const Adjacency> adjacency;
+    boost::shared_ptr<const ActiveNodes> active;
+    std::vector<Vrui::Point> positions;
+    std::vector<Vrui::Vector> velocities;
+    std::vector<float> sizes;
+    std::vector<int> slots;
+    int selectedSlot;
+    std::vector<Vrui::Vector> velocityVector;
+    std::vector<Vrui::Vector> positionVector;
+    
+    // outMarks[worker][t] == source iff source -> t, inMarks likewise t -> source
+    std::vector<std::vector<int> > outMarks;
+    std::vector<std::vector<int> > inMarks;
+    std::vector<PackedPoints> interactions; // by worker
+    
 public:
     ArfLayout(Mycelia*);
     
     double getSpringConstant(int) const;
     double getSpringLength(int) const;
+    
+    virtual void setWorkerCount(int);
+    virtual void computeForces(int, int, int);
 
 protected:
     virtual void* layout();
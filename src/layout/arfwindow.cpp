@@ -62,6 +62,12 @@ ArfWindow::ArfWindow(Mycelia* application)
     unconnectedConstantSlider = p.second;
     unconnectedConstantSlider->getValueChangedCallbacks().add(this, &ArfWindow::sliderCallback);
     
+    // opening angle slider, 0 is exact
+    p = VruiHelp::createParameter("Opening Angle", 0, 1.5, layout->openingAngle, dialog);
+    openingAngleField = p.first;
+    openingAngleSlider = p.second;
+    openingAngleSlider->getValueChangedCallbacks().add(this, &ArfWindow::sliderCallback);
+    
     GLMotif::Button* navButton = new GLMotif::Button("NavButton", dialog, "Center Graph");
     navButton->getSelectCallbacks().add(application, &Mycelia::resetNavigationCallback);
     
@@ -102,4 +108,9 @@ void ArfWindow::sliderCallback(GLMotif::Slider::ValueChangedCallbackData* cbData
         layout->unconnectedSpringConstant = f;
         unconnectedConstantField->setValue(f);
     }
+    else if(cbData->slider == openingAngleSlider)
+    {
+        layout->openingAngle = f;
+        openingAngleField->setValue(f);
+    }
 }
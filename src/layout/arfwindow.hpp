@@ -39,6 +39,7 @@ private:
     GLMotif::Slider* stronglyConnectedLengthSlider;
     GLMotif::Slider* connectedLengthSlider;
     GLMotif::Slider* unconnectedLengthSlider;
+    GLMotif::Slider* openingAngleSlider;
     
     GLMotif::TextField* dampingField;
     GLMotif::TextField* stepsizeField;
@@ -49,6 +50,7 @@ private:
     GLMotif::TextField* stronglyConnectedLengthField;
     GLMotif::TextField* connectedLengthField;
     GLMotif::TextField* unconnectedLengthField;
+    GLMotif::TextField* openingAngleField;
     
 public:
     ArfWindow(Mycelia*);
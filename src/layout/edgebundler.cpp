@@ -21,7 +21,8 @@
 using namespace std;
 
 EdgeBundler::EdgeBundler(Mycelia* application)
-    : GraphLayout(application)
+    : GraphLayout(application),
+      bundledVersion(-1)
 {
 }
 
@@ -51,6 +52,17 @@ void EdgeBundler::allocateSegments()
 
 void* EdgeBundler::layout()
 {
+    // the segments from the last full run still hold if nothing has moved
+    ChangeSet changes;
+    int version = application->g->getChanges(bundledVersion, changes);
+
+    if(bundledVersion >= 0 && !changes.hasPositions() && !changes.hasTopology())
+    {
+        application->g->redraw();
+        return 0;
+    }
+
+    bundledVersion = -1;
     cycle = 0;
     segments = SUBDIVISIONS_0;
     stepsize = STEPSIZE_0;
@@ -62,7 +74,7 @@ void* EdgeBundler::layout()
         for(int iteration = 0; iteration < iterations; iteration++)
         {
             layoutStep();
-            application->g->update();
+            application->g->redraw();
         }
         
         cycle++;
@@ -70,16 +82,36 @@ void* EdgeBundler::layout()
         stepsize /= 2.0;
         iterations *= 0.66;
     }
+
+    if(!stopped) bundledVersion = version;
     return 0;
 }
 
+// edges are indexed by slot
 void EdgeBundler::layoutStep()
 {
-    for(int firstEdge = 0; firstEdge < (int)application->g->getEdgeCount(); firstEdge++)
+    const vector<int>& edges = application->g->getEdges();
+    int edgeCount = segmentVector.size();
+    
+    // each segment is pulled toward the same segment of every other edge,
+    // packed here and kept up to date as segments move
+    packedSegments.resize(segments + 1);
+    
+    for(int segment = 1; segment <= segments; segment++)
+    {
+        packedSegments[segment].clear();
+        
+        for(int edge = 0; edge < edgeCount; edge++)
+        {
+            packedSegments[segment].push_back(*getSegment(edge, segment), 1);
+        }
+    }
+    
+    for(int firstEdge = 0; firstEdge < edgeCount; firstEdge++)
     {
-        Vrui::Scalar k_p = K / Geometry::abs(application->g->getSourceNodePosition(firstEdge) - application->g->getTargetNodePosition(firstEdge));
+        Vrui::Scalar k_p = K / Geometry::abs(application->g->getSourceNodePosition(edges[firstEdge]) - application->g->getTargetNodePosition(edges[firstEdge]));
         
-        for(int segment = 1; *getSegment(firstEdge, segment) != application->g->getTargetNodePosition(firstEdge); segment++)
+        for(int segment = 1; *getSegment(firstEdge, segment) != application->g->getTargetNodePosition(edges[firstEdge]); segment++)
         {
             Vrui::Point& p_prev     = *getSegment(firstEdge, segment - 1);
             Vrui::Point& p          = *getSegment(firstEdge, segment);
@@ -88,22 +120,7 @@ void EdgeBundler::layoutStep()
             Vrui::Vector F_s_prev_v = p_prev - p;
             Vrui::Vector F_s_next_v = p_next - p;
             Vrui::Vector F_s_v      = (F_s_prev_v + F_s_next_v) * k_p;
-            Vrui::Vector F_e_v      = Vrui::Vector(0, 0, 0);
-            
-            for(int secondEdge = 0; secondEdge < application->g->getEdgeCount(); secondEdge++)
-            {
-                if(firstEdge == secondEdge) continue;
-                
-                Vrui::Point& q = *getSegment(secondEdge, segment);
-                Vrui::Vector v = q - p;
-                Vrui::Scalar mag = Geometry::mag(v);
-                
-                if(mag > 0)
-                {
-                    Vrui::Vector F_e_v_delta = v / Math::pow(mag, 3); // power 2=linear, 3=quadratic
-                    F_e_v += F_e_v_delta;
-                }
-            }
+            Vrui::Vector F_e_v      = PackedForces::inverseSquare(p, packedSegments[segment]); // quadratic falloff
             
             Vrui::Vector force  = Vrui::Vector(0, 0, 0);
             Vrui::Vector F_v    = F_s_v + F_e_v;
@@ -116,6 +133,7 @@ void EdgeBundler::layoutStep()
             }
             
             p += force;
+            packedSegments[segment].set(firstEdge, p);
         }
     }
 }
@@ -125,6 +143,7 @@ inline int EdgeBundler::getIndex(int i) const
     return i * pow(2.0, MAX_CYCLE - cycle);
 }
 
+// edge is a slot, see Graph::getEdgeSlot()
 Vrui::Point* EdgeBundler::getSegment(int edge, int segment)
 {
     int index = getIndex(segment);
@@ -133,11 +152,11 @@ Vrui::Point* EdgeBundler::getSegment(int edge, int segment)
     {
         if(segment == 0)
         {
-            segmentVector[edge][index] = Vrui::Point(application->g->getSourceNodePosition(edge));
+            segmentVector[edge][index] = Vrui::Point(application->g->getSourceNodePosition(application->g->getEdges()[edge]));
         }
         else if(segment > segments)
         {
-            segmentVector[edge][index] = Vrui::Point(application->g->getTargetNodePosition(edge));
+            segmentVector[edge][index] = Vrui::Point(application->g->getTargetNodePosition(application->g->getEdges()[edge]));
         }
         else
         {
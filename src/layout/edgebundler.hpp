@@ -23,6 +23,7 @@
 #include <mycelia.hpp>
 #include <vruihelp.hpp>
 #include <layout/graphlayout.hpp>
+#include <layout/packedforces.hpp>
 
 #define SUBDIVISIONS_0      1
 #define STEPSIZE_0          0.04
@@ -38,6 +39,8 @@ private:
     int iterations;
     int cycle;
     std::vector<std::vector<Vrui::Point> > segmentVector;
+    std::vector<PackedPoints> packedSegments; // by segment, then edge
+    int bundledVersion; // change log version of the last full run
     
 public:
     EdgeBundler(Mycelia*);
@@ -0,0 +1,178 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <layout/forceengine.hpp>
+
+#include <algorithm>
+#include <unistd.h>
+
+using namespace std;
+
+ForceEngine::ForceEngine()
+    : threadCount(getProcessorCount()),
+      kernel(0),
+      count(0),
+      rangeCount(0),
+      generation(0),
+      pending(0),
+      quitting(false)
+{
+}
+
+ForceEngine::~ForceEngine()
+{
+    stopWorkers();
+}
+
+const int ForceEngine::getProcessorCount()
+{
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return processors > 0 ? processors : 1;
+}
+
+const int ForceEngine::getThreadCount() const
+{
+    return threadCount;
+}
+
+// takes effect on the next run(), so it can be called while one is going
+void ForceEngine::setThreadCount(int threadCount)
+{
+    mutex.lock();
+    this->threadCount = std::max(threadCount, 1);
+    mutex.unlock();
+}
+
+// calls kernel.computeForces() over [0, count) and returns when all is done
+void ForceEngine::run(ForceKernel& kernel, int count)
+{
+    mutex.lock();
+    int threads = threadCount;
+    mutex.unlock();
+
+    if((int)workers.size() != threads - 1)
+    {
+        startWorkers(threads);
+    }
+
+    int ranges = std::max(std::min(threads, count / MIN_RANGE), 1);
+    kernel.setWorkerCount(ranges);
+
+    if(ranges == 1)
+    {
+        kernel.computeForces(0, count, 0);
+        return;
+    }
+
+    mutex.lock();
+    this->kernel = &kernel;
+    this->count = count;
+    rangeCount = ranges;
+    pending = ranges - 1;
+    generation++;
+    runCond.broadcast();
+    mutex.unlock();
+
+    computeRange(0);
+
+    mutex.lock();
+    while(pending > 0)
+    {
+        doneCond.wait(mutex);
+    }
+    this->kernel = 0;
+    mutex.unlock();
+}
+
+void ForceEngine::computeRange(int range)
+{
+    if(range >= rangeCount) return;
+
+    int first = (long long)count * range / rangeCount;
+    int last = (long long)count * (range + 1) / rangeCount;
+    kernel->computeForces(first, last, range);
+}
+
+void ForceEngine::startWorkers(int threads)
+{
+    stopWorkers();
+
+    for(int i = 1; i < threads; i++)
+    {
+        Worker* worker = new Worker();
+        worker->engine = this;
+        worker->index = i;
+        worker->generation = generation;
+        workers.push_back(worker);
+        worker->thread.start(worker, &Worker::run);
+    }
+}
+
+void ForceEngine::stopWorkers()
+{
+    if(workers.empty()) return;
+
+    mutex.lock();
+    quitting = true;
+    runCond.broadcast();
+    mutex.unlock();
+
+    for(int i = 0; i < (int)workers.size(); i++)
+    {
+        workers[i]->thread.join();
+        delete workers[i];
+    }
+
+    workers.clear();
+    quitting = false;
+}
+
+/*
+ * Worker
+ */
+void* ForceEngine::Worker::run()
+{
+    engine->mutex.lock();
+
+    while(true)
+    {
+        while(!engine->quitting && engine->generation == generation)
+        {
+            engine->runCond.wait(engine->mutex);
+        }
+
+        if(engine->quitting) break;
+
+        generation = engine->generation;
+        bool working = index < engine->rangeCount;
+        engine->mutex.unlock();
+
+        // an idle worker mustn't look at the engine again, it may already be
+        // on the next run
+        if(working) engine->computeRange(index);
+
+        engine->mutex.lock();
+        if(working && --engine->pending == 0)
+        {
+            engine->doneCond.signal();
+        }
+    }
+
+    engine->mutex.unlock();
+    return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FORCEENGINE_HPP
+#define __FORCEENGINE_HPP
+
+#include <Threads/Cond.h>
+#include <Threads/Mutex.h>
+#include <Threads/Thread.h>
+#include <vector>
+
+/*
+ * The per-node half of a layout step. computeForces() is handed a range of
+ * the nodes to compute and must only write the forces of those nodes (owner
+ * computes), so ranges can run at the same time and the result doesn't
+ * depend on how they were split. worker picks the scratch space to use; run()
+ * first calls setWorkerCount() on its own thread so there is enough of it.
+ */
+class ForceKernel
+{
+public:
+    virtual ~ForceKernel() {}
+    virtual void setWorkerCount(int) {}
+    virtual void computeForces(int first, int last, int worker) = 0;
+};
+
+/*
+ * Runs a ForceKernel over count nodes on a pool of threads. The nodes are cut
+ * into one contiguous range per thread, the calling thread taking the first.
+ * Workers are started by run() and sleep between runs. Only one thread may
+ * call run().
+ */
+class ForceEngine
+{
+public:
+    static const int MIN_RANGE = 256; // smaller steps aren't worth a wakeup
+
+private:
+    class Worker
+    {
+    public:
+        ForceEngine* engine;
+        int index;
+        int generation; // of the last run done
+        Threads::Thread thread;
+
+        void* run();
+    };
+
+    std::vector<Worker*> workers;
+    int threadCount;
+
+    Threads::Mutex mutex;
+    Threads::Cond runCond;
+    Threads::Cond doneCond;
+    ForceKernel* kernel;
+    int count;
+    int rangeCount;
+    int generation;
+    int pending;
+    bool quitting;
+
+    void computeRange(int);
+    void startWorkers(int);
+    void stopWorkers();
+
+public:
+    ForceEngine();
+    ~ForceEngine();
+
+    static const int getProcessorCount();
+
+    const int getThreadCount() const;
+    void setThreadCount(int);
+    void run(ForceKernel&, int);
+};
+
+#endif
@@ -18,11 +18,69 @@
 
 #include <layout/frlayout.hpp>
 
+#include <iostream>
+#include <limits>
+#include <sys/time.h>
+
 using namespace std;
 
+static double now()
+{
+    timeval t;
+    gettimeofday(&t, 0);
+    return t.tv_sec + t.tv_usec * 1e-6;
+}
+
 FruchtermanReingoldLayout::FruchtermanReingoldLayout(Mycelia* application)
-    : GraphLayout(application)
+    : GraphLayout(application),
+      repulsion(REPULSION_BARNES_HUT),
+      openingAngle(OPENING_ANGLE),
+      tolerance(CONVERGENCE_TOLERANCE),
+      stepRepulsion(REPULSION_BARNES_HUT)
+{
+}
+
+const int FruchtermanReingoldLayout::getRepulsion() const
+{
+    return repulsion;
+}
+
+const double FruchtermanReingoldLayout::getOpeningAngle() const
 {
+    return openingAngle;
+}
+
+const double FruchtermanReingoldLayout::getTolerance() const
+{
+    return tolerance;
+}
+
+// REPULSION_EXACT sums over every pair of nodes, REPULSION_BARNES_HUT over an
+// octree of them, see setOpeningAngle(), and REPULSION_GRID over the pairs
+// closer than GRID_CUTOFF * k. Returns false for anything else, which
+// leaves it as it was. A running layout picks it up at its next step.
+const bool FruchtermanReingoldLayout::setRepulsion(int repulsion)
+{
+    if(repulsion != REPULSION_EXACT && repulsion != REPULSION_BARNES_HUT && repulsion != REPULSION_GRID)
+    {
+        return false;
+    }
+
+    this->repulsion = repulsion;
+    return true;
+}
+
+// how coarse a Barnes-Hut step may be, 0 is exact, see Octree
+void FruchtermanReingoldLayout::setOpeningAngle(double openingAngle)
+{
+    this->openingAngle = std::max(openingAngle, 0.0);
+}
+
+// the mean step, in units of k, at which the layout counts as converged; 0
+// runs it for ITERATION_LIMIT steps
+void FruchtermanReingoldLayout::setTolerance(double tolerance)
+{
+    this->tolerance = std::max(tolerance, 0.0);
 }
 
 void* FruchtermanReingoldLayout::layout()
@@ -33,13 +91,27 @@ void* FruchtermanReingoldLayout::layout()
         stopped = true;
         return 0;
     }
-    springForceConstant = Math::pow(VOLUME / numNodes, 1.0 / 3.0);
+    springForceConstant = Math::pow(VOLUME / (double)numNodes, 1.0 / 3.0);
+    temperature = INITIAL_STEP * springForceConstant;
+    energy = numeric_limits<double>::max();
+    displacement = numeric_limits<double>::max();
+    progress = 0;
     
-    for(remainingIterations = MAX_ITERATIONS; remainingIterations > 0 && !stopped; remainingIterations--)
+    double start = now();
+    
+    for(iterations = 0; iterations < ITERATION_LIMIT && !stopped; iterations++)
     {
+        if(displacement < tolerance * springForceConstant) break;
+        
         layoutStep();
     }
     
+    cout << "static layout: " << iterations << " iterations, energy " << energy
+         << ", " << now() - start << "s" << endl;
+    
+    octree.clear();
+    adjacency.reset();
+    active.reset();
     stopped = true;
     application->resetNavigationCallback(0);
 
@@ -48,71 +120,277 @@ void* FruchtermanReingoldLayout::layout()
 
 void FruchtermanReingoldLayout::layoutStep()
 {
-    // temperature affects rate of movement, starts at 1 and moves gradually to 0
-    double temperature = MAX_DELTA * Math::pow(remainingIterations / (double)MAX_ITERATIONS, COOLING_EXPONENT);
-    vector<Vrui::Vector> forceVector(application->g->getNodeCount());
+    Graph* g = application->g;
+    adjacency = g->getAdjacency();
+    active = g->getActiveNodes();
+    g->getNodePositions(positions);
+    int nodeCount = std::min(positions.size(), adjacency->inOffsets.size());
+    forceVector.assign(nodeCount, Vrui::Vector(0, 0, 0));
+    
+    // only the active nodes take part, the rest keep still
+    slots.clear();
+    foreach(int slot, active->slots)
+    {
+        if(slot < nodeCount) slots.push_back(slot);
+    }
+    
+    // repulsion is weighted by degree
+    degrees.resize(nodeCount);
+    foreach(int slot, slots)
+    {
+        degrees[slot] = adjacency->getDegree(slot);
+    }
+    
+    // setRepulsion() may be called mid step, computeForces() must use what
+    // was built here
+    stepRepulsion = repulsion;
     
-    // calculate repulsion between all nodes
-    foreach(int source, application->g->getNodes())
+    if(stepRepulsion == REPULSION_BARNES_HUT)
     {
-        if(!application->isSelectedComponent(source))
+        octree.build(positions, slots, degrees);
+    }
+    else if(stepRepulsion == REPULSION_GRID)
+    {
+        buildGrid();
+    }
+    else
+    {
+        packedNodes.clear();
+        foreach(int slot, slots)
         {
-            continue;
+            packedNodes.push_back(positions[slot], degrees[slot]);
+        }
+    }
+    
+    forceEngine.run(*this, slots.size());
+    g->updateNodePositions(forceVector);
+    
+    double stepEnergy = 0;
+    displacement = 0;
+    
+    for(int i = 0; i < (int)energies.size(); i++)
+    {
+        stepEnergy += energies[i];
+        displacement += displacements[i];
+    }
+    
+    if(slots.size() > 0) displacement /= slots.size();
+    
+    // the step for the next one
+    if(stepEnergy < energy)
+    {
+        if(++progress >= STEP_PATIENCE)
+        {
+            progress = 0;
+            temperature = std::min(temperature / STEP_RATIO, (double)MAX_DELTA);
         }
+    }
+    else
+    {
+        progress = 0;
+        temperature *= STEP_RATIO;
+    }
+    
+    energy = stepEnergy;
+}
+
+// zeroes the sums computeForces() adds to
+void FruchtermanReingoldLayout::setWorkerCount(int workers)
+{
+    interactions.resize(workers);
+    energies.assign(workers, 0);
+    displacements.assign(workers, 0);
+}
+
+// moves slots[first, last), each on its own so ranges can run in parallel
+void FruchtermanReingoldLayout::computeForces(int first, int last, int worker)
+{
+    int packedCell = -1;
+    
+    for(int i = first; i < last; i++)
+    {
+        int node = slots[i];
+        Vrui::Vector force = attract(node);
+        
+        if(stepRepulsion == REPULSION_BARNES_HUT) force += repulseBarnesHut(node, interactions[worker]);
+        else if(stepRepulsion == REPULSION_GRID) force += repulseGrid(i, interactions[worker], packedCell);
+        else force += repulseExact(node);
         
-        foreach(int target, application->g->getNodes())
+        // dampen motion
+        Vrui::Scalar mag = force.mag();
+        energies[worker] += mag * mag;
+        
+        if(mag > temperature)
         {
-            if(!application->isSelectedComponent(target) || source == target)
-            {
-                continue;
-            }
-            
-            // calculate repulsive force as k^2 / distance (or variant)
-            Vrui::Vector v = application->g->getNodePosition(source) - application->g->getNodePosition(target);
-            Vrui::Scalar mag = Geometry::mag(v);
-            
-            if(mag > 0) v = v.normalize();
-            else mag = 0.001;
-            
-            Vrui::Scalar repulsiveForce = springForceConstant * springForceConstant * (1 / mag - mag * mag / REPULSION_RADIUS);
-            Vrui::Scalar weightedForce = repulsiveForce * application->g->getNodeDegree(source);
-            
-            forceVector[source] += v * weightedForce;
-            forceVector[target] -= v * weightedForce;
-            
-            // attract connected nodes as distance^2 / k
-            if(application->g->hasEdge(source, target))
-            {
-                Vrui::Scalar attractiveForce = mag * mag / springForceConstant;
-                float edgeWeights = 0;
-                
-                foreach(int edge, application->g->getEdges(source, target))
-                {
-                    edgeWeights += application->g->getEdgeWeight(edge);
-                }
-                
-                attractiveForce *= edgeWeights;
-                forceVector[source] -= v * attractiveForce;
-                forceVector[target] += v * attractiveForce;
-            }
+            force *= temperature / mag;
+            mag = temperature;
         }
+        
+        displacements[worker] += mag;
+        forceVector[node] = force;
     }
+}
+
+// attract connected nodes as distance^2 / k, each edge is seen from both ends
+const Vrui::Vector FruchtermanReingoldLayout::attract(int source) const
+{
+    Vrui::Vector force(0, 0, 0);
     
-    // dampen motion and update position
-    for(int node = 0; node < application->g->getNodeCount(); node++)
+    for(int index = adjacency->offsets[source]; index < adjacency->offsets[source + 1]; index++)
     {
-        if(!application->isSelectedComponent(node))
+        int target = adjacency->neighbors[index];
+        
+        if(target >= (int)forceVector.size() || !active->isActive(target) || source == target)
         {
             continue;
         }
         
-        Vrui::Scalar mag = forceVector[node].mag();
+        Vrui::Vector v = positions[source] - positions[target];
+        Vrui::Scalar mag = Geometry::mag(v);
         
-        if(mag > temperature)
+        if(mag > 0) v = v.normalize();
+        else mag = 0.001;
+        
+        Vrui::Scalar attractiveForce = mag * mag / springForceConstant * adjacency->weights[index];
+        force -= v * attractiveForce;
+    }
+    
+    return force;
+}
+
+/*
+ * Repulsion between a pair is k^2 / distance (or variant), weighted by the
+ * degrees of both ends.
+ */
+const Vrui::Vector FruchtermanReingoldLayout::repulseExact(int source) const
+{
+    return PackedForces::fruchtermanReingold(positions[source], degrees[source], packedNodes, springForceConstant * springForceConstant, REPULSION_RADIUS);
+}
+
+const Vrui::Vector FruchtermanReingoldLayout::repulseBarnesHut(int source, PackedPoints& points) const
+{
+    FruchtermanReingoldInteractions visitor;
+    visitor.points = &points;
+    visitor.degree = degrees[source];
+    visitor.count = 1;
+    points.clear();
+    
+    octree.visit(positions[source], source, openingAngle, visitor);
+    return PackedForces::fruchtermanReingold(positions[source], 0, points, springForceConstant * springForceConstant, REPULSION_RADIUS);
+}
+
+/*
+ * Bins the active nodes into cubes at least GRID_CUTOFF * k on a side, so the
+ * pairs within the cutoff of a node are all in its cell or the 26 around it.
+ * The cells grow if need be to keep their count within twice the node count.
+ * The slots are sorted by cell, which lets neighboring sources share a packing.
+ */
+void FruchtermanReingoldLayout::buildGrid()
+{
+    if(slots.empty()) return;
+    
+    Vrui::Point lower = positions[slots[0]];
+    Vrui::Point upper = lower;
+    
+    foreach(int slot, slots)
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            lower[j] = std::min(lower[j], positions[slot][j]);
+            upper[j] = std::max(upper[j], positions[slot][j]);
+        }
+    }
+    
+    gridOrigin = lower;
+    cellSize = GRID_CUTOFF * springForceConstant;
+    double cellCount;
+    
+    while(true)
+    {
+        cellCount = 1;
+        
+        for(int j = 0; j < 3; j++)
         {
-            forceVector[node] *= temperature / mag;
+            gridSize[j] = (int)std::min((upper[j] - lower[j]) / cellSize, (Vrui::Scalar)slots.size()) + 1;
+            cellCount *= gridSize[j];
         }
         
-        application->g->updateNodePosition(node, forceVector[node]);
+        if(cellCount <= 2 * slots.size() + 1) break;
+        
+        cellSize *= std::max(Math::pow(cellCount / (2 * slots.size() + 1), 1.0 / 3.0), 1.01);
+    }
+    
+    // counting sort of the slots by cell
+    vector<int> cells(slots.size());
+    cellStarts.assign((int)cellCount + 1, 0);
+    
+    for(int i = 0; i < (int)slots.size(); i++)
+    {
+        int cell = 0;
+        
+        for(int j = 2; j >= 0; j--)
+        {
+            int c = (int)((positions[slots[i]][j] - gridOrigin[j]) / cellSize);
+            cell = cell * gridSize[j] + std::min(std::max(c, 0), gridSize[j] - 1);
+        }
+        
+        cells[i] = cell;
+        cellStarts[cell + 1]++;
+    }
+    
+    for(int cell = 0; cell < (int)cellCount; cell++)
+    {
+        cellStarts[cell + 1] += cellStarts[cell];
+    }
+    
+    vector<int> sorted(slots.size());
+    vector<int> next(cellStarts.begin(), cellStarts.end() - 1);
+    slotCells.resize(slots.size());
+    
+    for(int i = 0; i < (int)slots.size(); i++)
+    {
+        int index = next[cells[i]]++;
+        sorted[index] = slots[i];
+        slotCells[index] = cells[i];
+    }
+    
+    slots.swap(sorted);
+}
+
+/*
+ * Takes an index into slots rather than a slot. The cells around the source
+ * are packed once for a run of sources in the same cell, packedCell is the
+ * cell points was last packed for. The cutoff is the cell size, which is
+ * GRID_CUTOFF * k unless the grid had to grow.
+ */
+const Vrui::Vector FruchtermanReingoldLayout::repulseGrid(int index, PackedPoints& points, int& packedCell) const
+{
+    int source = slots[index];
+    int cell = slotCells[index];
+    
+    if(cell != packedCell)
+    {
+        int c[3] = {cell % gridSize[0], cell / gridSize[0] % gridSize[1], cell / gridSize[0] / gridSize[1]};
+        points.clear();
+        
+        for(int z = std::max(c[2] - 1, 0); z <= std::min(c[2] + 1, gridSize[2] - 1); z++)
+        {
+            for(int y = std::max(c[1] - 1, 0); y <= std::min(c[1] + 1, gridSize[1] - 1); y++)
+            {
+                for(int x = std::max(c[0] - 1, 0); x <= std::min(c[0] + 1, gridSize[0] - 1); x++)
+                {
+                    int neighbor = (z * gridSize[1] + y) * gridSize[0] + x;
+                    
+                    for(int j = cellStarts[neighbor]; j < cellStarts[neighbor + 1]; j++)
+                    {
+                        points.push_back(positions[slots[j]], degrees[slots[j]]);
+                    }
+                }
+            }
+        }
+        
+        packedCell = cell;
     }
+    
+    return PackedForces::fruchtermanReingold(positions[source], degrees[source], points, springForceConstant * springForceConstant, REPULSION_RADIUS, cellSize);
 }
@@ -22,22 +22,112 @@
 #include <graph.hpp>
 #include <mycelia.hpp>
 #include <layout/graphlayout.hpp>
+#include <layout/octree.hpp>
+#include <layout/packedforces.hpp>
 
-#define MAX_ITERATIONS 300
+#define MAX_ITERATIONS 300       // steps per level of the multilevel layout, the static one has ITERATION_LIMIT
 #define MAX_DELTA 100
+#define ITERATION_LIMIT 1000     // the static layout stops sooner once it converges
+#define CONVERGENCE_TOLERANCE 0.01 // converged once nodes move less than this many k a step
+#define INITIAL_STEP 3           // in units of k, it grows up to MAX_DELTA if need be
+#define STEP_RATIO 0.9           // the step shrinks by this when the energy goes up
+#define STEP_PATIENCE 5          // and grows by its inverse after this many steps down
 #define COOLING_EXPONENT 1.5
 #define VOLUME 1000
 #define REPULSION_RADIUS 10000
 
-class FruchtermanReingoldLayout : public GraphLayout
+// how repulsion is summed, see setRepulsion()
+#define REPULSION_EXACT 0
+#define REPULSION_BARNES_HUT 1
+#define REPULSION_GRID 2
+#define OPENING_ANGLE 0.8
+#define GRID_CUTOFF 2 // in units of k, pairs further apart than this don't repel
+
+/*
+ * A far cell of the octree stands in for its nodes twice: at its centroid for
+ * the degree(source) half of the weight, and at its degree-weighted centroid
+ * for the rest. The cells and nodes seen from one node are packed and summed
+ * together. A source that stands for count nodes (see MultilevelLayout) sees
+ * the rest count times.
+ */
+class FruchtermanReingoldInteractions
+{
+public:
+    PackedPoints* points;
+    Vrui::Scalar degree;
+    Vrui::Scalar count;
+    
+    void operator()(const Vrui::Point& centroid, Vrui::Scalar cellCount, const Vrui::Point& weightedCentroid, Vrui::Scalar weight)
+    {
+        if(degree != 0) points->push_back(centroid, degree * cellCount);
+        if(weight != 0) points->push_back(weightedCentroid, count * weight);
+    }
+};
+
+/*
+ * Runs until the nodes stop moving rather than for a fixed number of steps.
+ * The step length (temperature) adapts as in Hu's "Efficient and high quality
+ * force-directed graph drawing": it shrinks whenever the energy, the sum of
+ * squared forces, goes up, and grows again after STEP_PATIENCE steps in a row
+ * that brought it down. The layout is done when the mean displacement of a
+ * step falls under tolerance * k, or after ITERATION_LIMIT steps.
+ */
+class FruchtermanReingoldLayout : public GraphLayout, public ForceKernel
 {
 private:
-    int remainingIterations;
     double springForceConstant;
+    int repulsion;
+    double openingAngle;
+    double tolerance;
+    Octree octree;
+    
+    // the run so far
+    int iterations;
+    double energy;       // of the last step
+    double displacement; // mean, of the last step
+    int progress;        // steps in a row the energy went down
+    
+    // the step being computed, indexed by slot
+    int stepRepulsion; // repulsion as of the start of the step
+    double temperature;
+    boost::shared_ptr<const Adjacency> adjacency;
+    boost::shared_ptr<const ActiveNodes> active;
+    std::vector<Vrui::Point> positions;
+    std::vector<int> slots;
+    std::vector<Vrui::Scalar> degrees;
+    std::vector<Vrui::Vector> forceVector;
+    PackedPoints packedNodes; // the active nodes, weighted by degree
+    
+    // the active nodes binned by cell, see buildGrid()
+    Vrui::Point gridOrigin;
+    Vrui::Scalar cellSize;
+    int gridSize[3];
+    std::vector<int> cellStarts; // into slots, by cell
+    std::vector<int> slotCells;  // by index into slots
+    
+    std::vector<PackedPoints> interactions; // by worker, see repulseBarnesHut() and repulseGrid()
+    std::vector<double> energies;           // by worker
+    std::vector<double> displacements;      // by worker, summed
+    
+    const Vrui::Vector repulseExact(int) const;
+    const Vrui::Vector repulseBarnesHut(int, PackedPoints&) const;
+    const Vrui::Vector repulseGrid(int, PackedPoints&, int&) const;
+    void buildGrid();
+    const Vrui::Vector attract(int) const;
     
 public:
     FruchtermanReingoldLayout(Mycelia*);
     
+    const int getRepulsion() const;
+    const double getOpeningAngle() const;
+    const double getTolerance() const;
+    const bool setRepulsion(int);
+    void setOpeningAngle(double);
+    void setTolerance(double);
+    
+    virtual void setWorkerCount(int);
+    virtual void computeForces(int, int, int);
+    
 protected:
     virtual void* layout();
     virtual void layoutStep();
@@ -20,6 +20,7 @@
 #define __GRAPHLAYOUT_HPP
 
 #include <Threads/Thread.h>
+#include <layout/forceengine.hpp>
 
 class Mycelia;
 
@@ -30,6 +31,7 @@ protected:
     Threads::Thread* layoutThread;
     bool stopped;
     bool dynamic;
+    ForceEngine forceEngine;
 
     virtual void* layout() = 0;
 
@@ -68,6 +70,12 @@ public:
     {
         return dynamic;
     }
+    
+    // the number of threads forces are computed on, see ForceEngine
+    void setThreadCount(int threadCount)
+    {
+        forceEngine.setThreadCount(threadCount);
+    }
 };
 
 #endif
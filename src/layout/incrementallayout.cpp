@@ -0,0 +1,352 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <layout/incrementallayout.hpp>
+
+#include <algorithm>
+#include <tr1/unordered_map>
+#include <unistd.h>
+
+using namespace std;
+
+IncrementalLayout::IncrementalLayout(Mycelia* application)
+    : MultilevelLayout(application),
+      version(-1)
+{
+    dynamic = true;
+}
+
+// the next start lays out the whole graph again
+void IncrementalLayout::reset()
+{
+    version = -1;
+    unplaced.clear();
+}
+
+void* IncrementalLayout::layout()
+{
+    Graph* g = application->g;
+    ChangeSet changes;
+    vector<int> seeds;
+    
+    while(!stopped)
+    {
+        int current = g->getChanges(version, changes);
+        
+        // after reset(), or more changes than the log keeps
+        if(changes.reload)
+        {
+            version = current;
+            unplaced.clear();
+            
+            if(g->getNodeCount() > 0)
+            {
+                layoutGraph();
+                if(!stopped) application->resetNavigationCallback(0);
+            }
+            
+            continue;
+        }
+        
+        version = current;
+        gather(changes, seeds);
+        
+        if(seeds.empty())
+        {
+            usleep(INCREMENTAL_POLL * 1000);
+            continue;
+        }
+        
+        collect(seeds);
+        place();
+        relax();
+    }
+    
+    regionTree.clear();
+    return 0;
+}
+
+// The ends of every node or edge added or removed, in the order they were.
+// New nodes are unplaced unless they were given a position right away.
+void IncrementalLayout::gather(const ChangeSet& changes, vector<int>& seeds)
+{
+    seeds.clear();
+    
+    foreach(const Change& c, changes.structure)
+    {
+        switch(c.kind)
+        {
+        case ChangeLog::NODE_ADDED:
+            if(!ChangeSet::isMarked(changes.positions, c.id)) unplaced.insert(c.id);
+            seeds.push_back(c.id);
+            break;
+        case ChangeLog::NODE_REMOVED:
+            unplaced.erase(c.id);
+            break;
+        default:
+            seeds.push_back(c.source);
+            seeds.push_back(c.target);
+            break;
+        }
+    }
+}
+
+/*
+ * Copies the neighborhood of the seeds out of the graph, breadth first. The
+ * seeds and the active nodes within INCREMENTAL_HOPS of them move, up to
+ * INCREMENTAL_MAX_NODES past the seeds; the neighbors of those that don't
+ * make it keep still. The graph stays locked meanwhile, which takes time in
+ * proportion to the edges read.
+ */
+void IncrementalLayout::collect(const vector<int>& seeds)
+{
+    Graph* g = application->g;
+    tr1::unordered_map<int, int> indexes; // into region.nodes, by id
+    vector<int> hops;
+    vector<int> neighbors;
+    vector<float> weights;
+    
+    region.nodes.clear();
+    region.offsets.assign(1, 0);
+    region.neighbors.clear();
+    region.weights.clear();
+    region.placed.clear();
+    region.positions.clear();
+    
+    g->lock();
+    
+    foreach(int node, seeds)
+    {
+        if(!g->isValidNode(node) || !g->isActiveNode(node) || indexes.count(node) > 0) continue;
+        
+        indexes[node] = region.nodes.size();
+        region.nodes.push_back(node);
+        hops.push_back(0);
+    }
+    
+    int limit = region.nodes.size() + INCREMENTAL_MAX_NODES;
+    int i = 0;
+    
+    for(; i < (int)region.nodes.size() && i < limit && hops[i] <= INCREMENTAL_HOPS; i++)
+    {
+        g->getNodeNeighbors(region.nodes[i], neighbors, weights);
+        
+        for(int k = 0; k < (int)neighbors.size(); k++)
+        {
+            if(!g->isActiveNode(neighbors[k])) continue;
+            
+            tr1::unordered_map<int, int>::iterator found = indexes.find(neighbors[k]);
+            int index;
+            
+            if(found == indexes.end())
+            {
+                index = region.nodes.size();
+                indexes[neighbors[k]] = index;
+                region.nodes.push_back(neighbors[k]);
+                hops.push_back(hops[i] + 1);
+            }
+            else
+            {
+                index = found->second;
+            }
+            
+            region.neighbors.push_back(index);
+            region.weights.push_back(weights[k]);
+        }
+        
+        region.offsets.push_back(region.neighbors.size());
+    }
+    
+    region.movable = i;
+    
+    foreach(int node, region.nodes)
+    {
+        region.positions.push_back(g->getNodePosition(node));
+        region.placed.push_back(unplaced.count(node) == 0);
+    }
+    
+    g->unlock();
+    
+    region.start.assign(region.positions.begin(), region.positions.begin() + region.movable);
+}
+
+/*
+ * Puts each unplaced node that moves at the barycenter of its placed
+ * neighbors, breadth first from the placed ones so a chain of new nodes trails
+ * off from where it's attached. Nodes with no way to a placed one stay where
+ * Graph::addNode() put them.
+ */
+void IncrementalLayout::place()
+{
+    // the edges there are already set the scale, the median so that one node
+    // given a far off position doesn't
+    vector<Vrui::Scalar> lengths;
+    
+    for(int i = 0; i < region.movable; i++)
+    {
+        for(int index = region.offsets[i]; index < region.offsets[i + 1]; index++)
+        {
+            int j = region.neighbors[index];
+            
+            if(i != j && region.placed[i] && region.placed[j])
+            {
+                lengths.push_back(Geometry::dist(region.positions[i], region.positions[j]));
+            }
+        }
+    }
+    
+    edgeLength = 0;
+    
+    if(!lengths.empty())
+    {
+        std::nth_element(lengths.begin(), lengths.begin() + lengths.size() / 2, lengths.end());
+        edgeLength = lengths[lengths.size() / 2];
+    }
+    
+    if(edgeLength == 0)
+    {
+        edgeLength = Math::pow(VOLUME / (double)std::max(application->g->getNodeCount(), 1), 1.0 / 3.0);
+    }
+    
+    vector<int> queue;
+    vector<bool> queued(region.movable, false);
+    
+    for(int i = 0; i < region.movable; i++)
+    {
+        for(int index = region.offsets[i]; index < region.offsets[i + 1] && !region.placed[i]; index++)
+        {
+            if(region.placed[region.neighbors[index]])
+            {
+                queue.push_back(i);
+                queued[i] = true;
+                break;
+            }
+        }
+    }
+    
+    for(int q = 0; q < (int)queue.size(); q++)
+    {
+        int i = queue[q];
+        Vrui::Vector sum(0, 0, 0);
+        Vrui::Scalar placedNeighbors = 0;
+        
+        for(int index = region.offsets[i]; index < region.offsets[i + 1]; index++)
+        {
+            int j = region.neighbors[index];
+            
+            if(region.placed[j])
+            {
+                sum += region.positions[j] - Vrui::Point::origin;
+                placedNeighbors++;
+            }
+            else if(j < region.movable && !queued[j])
+            {
+                queue.push_back(j);
+                queued[j] = true;
+            }
+        }
+        
+        Vrui::Vector jitter(2 * VruiHelp::randomFloat() - 1,
+                            2 * VruiHelp::randomFloat() - 1,
+                            2 * VruiHelp::randomFloat() - 1);
+        
+        region.positions[i] = Vrui::Point::origin + sum / placedNeighbors + jitter * (INCREMENTAL_JITTER * edgeLength);
+        region.placed[i] = true;
+        unplaced.erase(region.nodes[i]);
+    }
+}
+
+/*
+ * Fruchterman-Reingold with k set to the length of the edges around, every
+ * node of the region repulsing the rest through an octree. Of the nodes
+ * outside the region only its fixed neighbors are seen, which is what keeps
+ * an edit cheap.
+ */
+void IncrementalLayout::relax()
+{
+    int size = region.nodes.size();
+    int movable = region.movable;
+    
+    if(movable == 0)
+    {
+        return;
+    }
+    
+    bodies.resize(size);
+    for(int i = 0; i < size; i++)
+    {
+        bodies[i] = i;
+    }
+    
+    regionForces.resize(movable);
+    Vrui::Scalar k = edgeLength;
+    FruchtermanReingoldInteractions visitor;
+    visitor.points = &regionPoints;
+    visitor.degree = 0;
+    visitor.count = 1;
+    
+    for(int iteration = 0; iteration < INCREMENTAL_ITERATIONS && !stopped; iteration++)
+    {
+        double remaining = (INCREMENTAL_ITERATIONS - iteration) / (double)INCREMENTAL_ITERATIONS;
+        double temperature = INCREMENTAL_DELTA * k * Math::pow(remaining, COOLING_EXPONENT);
+        
+        regionTree.build(region.positions, bodies, vector<Vrui::Scalar>());
+        
+        for(int i = 0; i < movable; i++)
+        {
+            const Vrui::Point& p = region.positions[i];
+            Vrui::Vector force(0, 0, 0);
+            
+            for(int index = region.offsets[i]; index < region.offsets[i + 1]; index++)
+            {
+                Vrui::Vector v = p - region.positions[region.neighbors[index]];
+                Vrui::Scalar mag = Geometry::mag(v);
+                
+                if(mag > 0) force -= v * (mag / k * region.weights[index]);
+            }
+            
+            regionPoints.clear();
+            regionTree.visit(p, i, OPENING_ANGLE, visitor);
+            force += PackedForces::fruchtermanReingold(p, 0, regionPoints, k * k, REPULSION_RADIUS);
+            
+            Vrui::Scalar mag = force.mag();
+            
+            if(mag > temperature)
+            {
+                force *= temperature / mag;
+            }
+            
+            regionForces[i] = force;
+        }
+        
+        for(int i = 0; i < movable; i++)
+        {
+            region.positions[i] += regionForces[i];
+        }
+    }
+    
+    vector<int> nodes(region.nodes.begin(), region.nodes.begin() + movable);
+    vector<Vrui::Vector> deltas(movable);
+    
+    for(int i = 0; i < movable; i++)
+    {
+        deltas[i] = region.positions[i] - region.start[i];
+    }
+    
+    application->g->updateNodePositions(nodes, deltas);
+}
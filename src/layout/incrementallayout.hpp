@@ -0,0 +1,85 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __INCREMENTALLAYOUT_HPP
+#define __INCREMENTALLAYOUT_HPP
+
+#include <graph.hpp>
+#include <mycelia.hpp>
+#include <layout/multilevellayout.hpp>
+#include <tr1/unordered_set>
+
+#define INCREMENTAL_HOPS 2         // nodes this many edges from a change are relaxed
+#define INCREMENTAL_MAX_NODES 2000 // but no more than this many past the changed ones
+#define INCREMENTAL_ITERATIONS 30  // steps per batch of changes
+#define INCREMENTAL_DELTA 1        // starting temperature, in edge lengths
+#define INCREMENTAL_JITTER 0.1     // in edge lengths, keeps new leaves of one node apart
+#define INCREMENTAL_POLL 20        // milliseconds between looks at the change log
+
+/*
+ * Follows edits to the graph without disturbing the layout the user already
+ * knows. A reset lays out the whole graph as MultilevelLayout does; from then
+ * on the layout watches the graph's change log. A new node goes to the
+ * barycenter of its neighbors that are already placed, unless it was added
+ * with a position, and the nodes within INCREMENTAL_HOPS of every change are
+ * relaxed for a few Fruchterman-Reingold steps. Their neighbors outside the
+ * neighborhood keep still and hold it in place; nothing else moves or is
+ * looked at, so an edit costs in proportion to the neighborhood it touches.
+ */
+class IncrementalLayout : public MultilevelLayout
+{
+private:
+    class Region
+    {
+    public:
+        std::vector<int> nodes;     // ids, the first movable of them move
+        int movable;
+        std::vector<int> offsets;   // movable + 1 entries
+        std::vector<int> neighbors; // indexes into nodes
+        std::vector<float> weights;
+        std::vector<bool> placed;
+        std::vector<Vrui::Point> positions;
+        std::vector<Vrui::Point> start; // of the movable ones, as the graph has them
+    };
+
+    int version; // of the change log, -1 to lay out from scratch
+    std::tr1::unordered_set<int> unplaced; // added since, no placed neighbor yet
+
+    // the batch being relaxed
+    Region region;
+    Vrui::Scalar edgeLength;
+    Octree regionTree;
+    std::vector<int> bodies; // 0 to region size, for regionTree
+    std::vector<Vrui::Vector> regionForces;
+    PackedPoints regionPoints; // see FruchtermanReingoldInteractions
+
+    void gather(const ChangeSet&, std::vector<int>&);
+    void collect(const std::vector<int>&);
+    void place();
+    void relax();
+
+public:
+    IncrementalLayout(Mycelia*);
+
+    void reset();
+
+protected:
+    virtual void* layout();
+};
+
+#endif
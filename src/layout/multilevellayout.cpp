@@ -0,0 +1,416 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <layout/multilevellayout.hpp>
+#include <vruihelp.hpp>
+
+using namespace std;
+
+MultilevelLayout::MultilevelLayout(Mycelia* application)
+    : GraphLayout(application),
+      openingAngle(MULTILEVEL_OPENING_ANGLE)
+{
+}
+
+void* MultilevelLayout::layout()
+{
+    if(application->g->getNodeCount() == 0)
+    {
+        stopped = true;
+        return 0;
+    }
+    
+    layoutGraph();
+    stopped = true;
+    application->resetNavigationCallback(0);
+    
+    return 0;
+}
+
+// lays out the active nodes once, giving up if the graph changes meanwhile
+void MultilevelLayout::layoutGraph()
+{
+    int numNodes = application->g->getNodeCount();
+    if(numNodes == 0) return;
+    springForceConstant = Math::pow(VOLUME / (double)numNodes, 1.0 / 3.0);
+    
+    build();
+    
+    // the coarsest level starts from where the nodes are, the rest from where
+    // their parents ended up
+    int coarsest = levels.size() - 1;
+    layoutLevel(coarsest, MAX_ITERATIONS, MAX_DELTA);
+    
+    for(int l = coarsest - 1; l >= 0 && !stopped; l--)
+    {
+        if(!updateGraph(l + 1)) break;
+        
+        prolong(l + 1);
+        int iterations = std::max(MIN_LEVEL_ITERATIONS, LEVEL_WORK / levels[l].size());
+        layoutLevel(l, std::min(iterations, MAX_ITERATIONS), REFINE_DELTA);
+    }
+    
+    levels.clear();
+    octree.clear();
+    adjacency.reset();
+}
+
+// levels[0] is copied from the graph, the rest coarsened from it
+void MultilevelLayout::build()
+{
+    Graph* g = application->g;
+    adjacency = g->getAdjacency();
+    boost::shared_ptr<const ActiveNodes> active = g->getActiveNodes();
+    vector<Vrui::Point> positions;
+    g->getNodePositions(positions);
+    int nodeCount = std::min(positions.size(), adjacency->inOffsets.size());
+    
+    // only the active nodes take part, the rest keep still
+    vector<int> indexes(nodeCount, -1); // in levels[0], by slot
+    slots.clear();
+    
+    foreach(int slot, active->slots)
+    {
+        if(slot >= nodeCount) continue;
+        
+        indexes[slot] = slots.size();
+        slots.push_back(slot);
+    }
+    
+    levels.assign(1, Level());
+    Level& finest = levels[0];
+    finest.offsets.push_back(0);
+    
+    foreach(int slot, slots)
+    {
+        for(int index = adjacency->offsets[slot]; index < adjacency->offsets[slot + 1]; index++)
+        {
+            int target = adjacency->neighbors[index];
+            
+            if(target >= nodeCount || indexes[target] == -1 || target == slot)
+            {
+                continue;
+            }
+            
+            finest.neighbors.push_back(indexes[target]);
+            finest.weights.push_back(adjacency->weights[index]);
+        }
+        
+        finest.offsets.push_back(finest.neighbors.size());
+        finest.degrees.push_back(adjacency->getDegree(slot));
+        finest.counts.push_back(1);
+        finest.positions.push_back(positions[slot]);
+    }
+    
+    while(levels.back().size() > COARSEST_SIZE)
+    {
+        levels.resize(levels.size() + 1);
+        
+        if(!coarsen(levels[levels.size() - 2], levels.back()))
+        {
+            levels.pop_back();
+            break;
+        }
+    }
+}
+
+/*
+ * Fills in fine.parents and coarse, false if coarse would keep more than
+ * MIN_COARSENING of the nodes. Nodes pick a partner in order of degree, so
+ * leaves are matched to their hub before it picks one itself.
+ */
+const bool MultilevelLayout::coarsen(Level& fine, Level& coarse)
+{
+    int n = fine.size();
+    vector<pair<int, int> > order; // (degree, node)
+    order.reserve(n);
+    
+    for(int node = 0; node < n; node++)
+    {
+        order.push_back(pair<int, int>(fine.offsets[node + 1] - fine.offsets[node], node));
+    }
+    
+    std::sort(order.begin(), order.end());
+    
+    // each node takes the free neighbor with the heaviest edge for the size
+    // of the pair
+    vector<int>& parents = fine.parents;
+    vector<Vrui::Scalar>& counts = coarse.counts;
+    parents.assign(n, -1);
+    counts.clear();
+    
+    for(int i = 0; i < n; i++)
+    {
+        int node = order[i].second;
+        if(parents[node] != -1) continue;
+        
+        int partner = -1;
+        double heaviest = 0;
+        
+        for(int index = fine.offsets[node]; index < fine.offsets[node + 1]; index++)
+        {
+            int neighbor = fine.neighbors[index];
+            if(parents[neighbor] != -1) continue;
+            
+            double weight = fine.weights[index] / (fine.counts[node] + fine.counts[neighbor]);
+            
+            if(partner == -1 || weight > heaviest)
+            {
+                partner = neighbor;
+                heaviest = weight;
+            }
+        }
+        
+        if(partner == -1) continue;
+        
+        parents[node] = parents[partner] = counts.size();
+        counts.push_back(fine.counts[node] + fine.counts[partner]);
+    }
+    
+    // every neighbor of a node left over has been matched, so it joins the
+    // smallest of their pairs; nodes without neighbors pair up with each other
+    int alone = -1;
+    
+    for(int i = 0; i < n; i++)
+    {
+        int node = order[i].second;
+        if(parents[node] != -1) continue;
+        
+        int parent = -1;
+        
+        for(int index = fine.offsets[node]; index < fine.offsets[node + 1]; index++)
+        {
+            int p = parents[fine.neighbors[index]];
+            if(parent == -1 || counts[p] < counts[parent]) parent = p;
+        }
+        
+        if(parent == -1 && alone != -1)
+        {
+            parent = parents[alone];
+            alone = -1;
+        }
+        else if(parent == -1)
+        {
+            parent = counts.size();
+            counts.push_back(0);
+            alone = node;
+        }
+        
+        parents[node] = parent;
+        counts[parent] += fine.counts[node];
+    }
+    
+    int size = counts.size();
+    
+    if(size > MIN_COARSENING * n)
+    {
+        parents.clear();
+        return false;
+    }
+    
+    // the nodes of each coarse node, side by side
+    vector<int> firsts(size + 1, 0);
+    vector<int> members(n);
+    
+    for(int node = 0; node < n; node++)
+    {
+        firsts[parents[node] + 1]++;
+    }
+    
+    for(int parent = 0; parent < size; parent++)
+    {
+        firsts[parent + 1] += firsts[parent];
+    }
+    
+    vector<int> next(firsts.begin(), firsts.end() - 1);
+    
+    for(int node = 0; node < n; node++)
+    {
+        members[next[parents[node]]++] = node;
+    }
+    
+    // edges between the same pair of coarse nodes add up, edges inside one
+    // are dropped
+    vector<int> marks(size, -1);  // marks[p] == parent iff parent -> p seen
+    vector<int> indexes(size, 0); // of parent -> p in coarse.neighbors
+    coarse.offsets.assign(1, 0);
+    coarse.neighbors.clear();
+    coarse.weights.clear();
+    coarse.degrees.assign(size, 0);
+    coarse.positions.resize(size);
+    
+    for(int parent = 0; parent < size; parent++)
+    {
+        // starts where one of its nodes is, averaging would pull them all in
+        coarse.positions[parent] = fine.positions[members[firsts[parent]]];
+        
+        for(int i = firsts[parent]; i < firsts[parent + 1]; i++)
+        {
+            int node = members[i];
+            coarse.degrees[parent] += fine.degrees[node];
+            
+            for(int index = fine.offsets[node]; index < fine.offsets[node + 1]; index++)
+            {
+                int p = parents[fine.neighbors[index]];
+                if(p == parent) continue;
+                
+                if(marks[p] != parent)
+                {
+                    marks[p] = parent;
+                    indexes[p] = coarse.neighbors.size();
+                    coarse.neighbors.push_back(p);
+                    coarse.weights.push_back(fine.weights[index]);
+                }
+                else
+                {
+                    coarse.weights[indexes[p]] += fine.weights[index];
+                }
+            }
+        }
+        
+        coarse.offsets.push_back(coarse.neighbors.size());
+    }
+    
+    return true;
+}
+
+// places the nodes of levels[l - 1] around their parents, close enough that
+// pairs repulse each other apart first
+void MultilevelLayout::prolong(int l)
+{
+    Level& fine = levels[l - 1];
+    const Level& coarse = levels[l];
+    
+    for(int node = 0; node < fine.size(); node++)
+    {
+        Vrui::Vector jitter(2 * VruiHelp::randomFloat() - 1, 2 * VruiHelp::randomFloat() - 1, 2 * VruiHelp::randomFloat() - 1);
+        fine.positions[node] = coarse.positions[fine.parents[node]] + jitter * springForceConstant;
+    }
+}
+
+// cools from delta to 0 over iterations steps, levels[0] is shown as it moves
+void MultilevelLayout::layoutLevel(int l, int iterations, double delta)
+{
+    level = &levels[l];
+    int size = level->size();
+    
+    nodes.resize(size);
+    for(int node = 0; node < size; node++)
+    {
+        nodes[node] = node;
+    }
+    
+    forceVector.resize(size);
+    
+    for(int iteration = 0; iteration < iterations && !stopped; iteration++)
+    {
+        temperature = delta * Math::pow((iterations - iteration) / (double)iterations, COOLING_EXPONENT);
+        
+        octree.build(level->positions, nodes, level->degrees, level->counts);
+        forceEngine.run(*this, size);
+        
+        for(int node = 0; node < size; node++)
+        {
+            level->positions[node] += forceVector[node];
+        }
+        
+        if(l == 0 && !updateGraph(0)) break;
+    }
+}
+
+// moves the graph's nodes to their parents in levels[l], false if the graph
+// has changed since build() and can't be
+const bool MultilevelLayout::updateGraph(int l)
+{
+    Graph* g = application->g;
+    
+    // a new adjacency may only carry new weights, the levels still fit it
+    if(g->getTopologyVersion() != adjacency->topologyVersion)
+    {
+        return false;
+    }
+    
+    vector<Vrui::Point> positions;
+    g->getNodePositions(positions);
+    vector<Vrui::Vector> deltas(positions.size(), Vrui::Vector(0, 0, 0));
+    
+    for(int i = 0; i < (int)slots.size(); i++)
+    {
+        int node = i;
+        
+        for(int j = 0; j < l; j++)
+        {
+            node = levels[j].parents[node];
+        }
+        
+        deltas[slots[i]] = levels[l].positions[node] - positions[slots[i]];
+    }
+    
+    g->updateNodePositions(deltas);
+    return true;
+}
+
+void MultilevelLayout::setWorkerCount(int workers)
+{
+    interactions.resize(workers);
+}
+
+// moves nodes [first, last) of the level being laid out by the forces of the
+// static layout, see FruchtermanReingoldLayout
+void MultilevelLayout::computeForces(int first, int last, int worker)
+{
+    const Level& l = *level;
+    PackedPoints& points = interactions[worker];
+    Vrui::Scalar k2 = springForceConstant * springForceConstant;
+    
+    for(int node = first; node < last; node++)
+    {
+        const Vrui::Point& p = l.positions[node];
+        Vrui::Vector force(0, 0, 0);
+        
+        for(int index = l.offsets[node]; index < l.offsets[node + 1]; index++)
+        {
+            Vrui::Vector v = p - l.positions[l.neighbors[index]];
+            Vrui::Scalar mag = Geometry::mag(v);
+            
+            if(mag > 0) v = v.normalize();
+            else mag = 0.001;
+            
+            force -= v * (mag * mag / springForceConstant * l.weights[index]);
+        }
+        
+        FruchtermanReingoldInteractions visitor;
+        visitor.points = &points;
+        visitor.degree = l.degrees[node];
+        visitor.count = l.counts[node];
+        points.clear();
+        
+        octree.visit(p, node, openingAngle, visitor);
+        force += PackedForces::fruchtermanReingold(p, 0, points, k2, REPULSION_RADIUS);
+        
+        // dampen motion
+        Vrui::Scalar mag = force.mag();
+        
+        if(mag > temperature)
+        {
+            force *= temperature / mag;
+        }
+        
+        forceVector[node] = force;
+    }
+}
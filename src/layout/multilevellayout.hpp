@@ -0,0 +1,100 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MULTILEVELLAYOUT_HPP
+#define __MULTILEVELLAYOUT_HPP
+
+#include <graph.hpp>
+#include <mycelia.hpp>
+#include <layout/frlayout.hpp>
+#include <layout/graphlayout.hpp>
+#include <layout/octree.hpp>
+#include <layout/packedforces.hpp>
+
+#define COARSEST_SIZE 100        // coarsening stops below this many nodes
+#define MIN_COARSENING 0.8       // or when a level keeps more of the last than this
+#define LEVEL_WORK 100000        // a level of n nodes is refined for LEVEL_WORK / n steps
+#define MIN_LEVEL_ITERATIONS 6   // but at least this many
+#define REFINE_DELTA 5           // starting temperature of every level but the coarsest
+#define MULTILEVEL_OPENING_ANGLE 1.2 // refining only moves nodes locally
+
+/*
+ * Fruchterman-Reingold over a hierarchy of ever coarser graphs. Each coarser
+ * level merges the nodes of a matching of the one below, heaviest edges
+ * first, and the nodes left unmatched into a neighbor's pair. The coarsest
+ * level is laid out from scratch, then every finer level starts with its
+ * nodes where their parents ended up and is refined in a few short steps.
+ *
+ * A coarse node stands for count nodes of the graph and repulses with their
+ * summed degree, so every level has the forces of the static layout between
+ * its clusters and ends up about the same size.
+ */
+class MultilevelLayout : public GraphLayout, public ForceKernel
+{
+private:
+    class Level
+    {
+    public:
+        std::vector<int> offsets;   // node count + 1 entries
+        std::vector<int> neighbors; // nodes of this level
+        std::vector<float> weights;
+        std::vector<Vrui::Scalar> degrees; // summed over the graph nodes below
+        std::vector<Vrui::Scalar> counts;  // of graph nodes below
+        std::vector<int> parents;          // in the next coarser level
+        std::vector<Vrui::Point> positions;
+
+        const int size() const
+        {
+            return counts.size();
+        }
+    };
+
+    double springForceConstant;
+    double openingAngle;
+    Octree octree;
+
+    // levels[0] is the active nodes of the graph, slots[i] being node i
+    boost::shared_ptr<const Adjacency> adjacency;
+    std::vector<int> slots;
+    std::vector<Level> levels;
+
+    // the step being computed
+    Level* level;
+    double temperature;
+    std::vector<int> nodes; // 0 to level size, for the octree
+    std::vector<Vrui::Vector> forceVector;
+    std::vector<PackedPoints> interactions; // by worker, see FruchtermanReingoldInteractions
+
+    void build();
+    const bool coarsen(Level&, Level&);
+    void prolong(int);
+    void layoutLevel(int, int, double);
+    const bool updateGraph(int);
+
+public:
+    MultilevelLayout(Mycelia*);
+
+    virtual void setWorkerCount(int);
+    virtual void computeForces(int, int, int);
+
+protected:
+    void layoutGraph();
+    virtual void* layout();
+};
+
+#endif
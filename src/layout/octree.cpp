@@ -0,0 +1,204 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <layout/octree.hpp>
+
+using namespace std;
+
+/*
+ * Builds the tree over the given slots of positions. weights and counts are
+ * indexed by slot too, or empty to weigh and count every body 1.
+ */
+void Octree::build(const vector<Vrui::Point>& positions, const vector<int>& slots, const vector<Vrui::Scalar>& weights, const vector<Vrui::Scalar>& counts)
+{
+    clear();
+
+    if(slots.empty()) return;
+
+    Vrui::Point min = positions[slots[0]];
+    Vrui::Point max = min;
+
+    bodies = slots;
+    bodyPositions.resize(slots.size());
+    bodyWeights.resize(slots.size());
+    bodyCounts.resize(slots.size());
+
+    for(int i = 0; i < (int)slots.size(); i++)
+    {
+        const Vrui::Point& p = positions[slots[i]];
+        bodyPositions[i] = p;
+        bodyWeights[i] = weights.empty() ? 1 : weights[slots[i]];
+        bodyCounts[i] = counts.empty() ? 1 : counts[slots[i]];
+
+        for(int j = 0; j < 3; j++)
+        {
+            if(p[j] < min[j]) min[j] = p[j];
+            if(p[j] > max[j]) max[j] = p[j];
+        }
+    }
+
+    Cell root;
+    root.size = 0;
+
+    for(int j = 0; j < 3; j++)
+    {
+        root.center[j] = (min[j] + max[j]) / 2;
+        root.size = std::max(root.size, max[j] - min[j]);
+    }
+
+    root.size = root.size * 1.0001 + 1e-9; // keep the extremes strictly inside
+    root.firstBody = 0;
+    root.bodyCount = slots.size();
+    cells.push_back(root);
+
+    octantScratch.resize(slots.size());
+    bodyScratch.resize(slots.size());
+    positionScratch.resize(slots.size());
+    weightScratch.resize(slots.size());
+    countScratch.resize(slots.size());
+
+    build(0, 0, slots.size(), 0);
+}
+
+// Splits cells[cell] over bodies[first, first + count) and fills in its sums.
+void Octree::build(int cell, int first, int count, int depth)
+{
+    cells[cell].firstChild = 0;
+    cells[cell].childCount = 0;
+    cells[cell].firstBody = first;
+    cells[cell].bodyCount = count;
+
+    if(count > LEAF_SIZE && depth < MAX_DEPTH)
+    {
+        // counting sort of the bodies by octant
+        Vrui::Point center = cells[cell].center;
+        int octants[8] = {0};
+
+        for(int i = first; i < first + count; i++)
+        {
+            const Vrui::Point& p = bodyPositions[i];
+            int octant = (p[0] >= center[0]) | (p[1] >= center[1]) << 1 | (p[2] >= center[2]) << 2;
+            octantScratch[i] = octant;
+            octants[octant]++;
+        }
+
+        int starts[8];
+        int start = first;
+
+        for(int octant = 0; octant < 8; octant++)
+        {
+            starts[octant] = start;
+            start += octants[octant];
+        }
+
+        int next[8];
+        std::copy(starts, starts + 8, next);
+
+        for(int i = first; i < first + count; i++)
+        {
+            int to = next[octantScratch[i]]++;
+            bodyScratch[to] = bodies[i];
+            positionScratch[to] = bodyPositions[i];
+            weightScratch[to] = bodyWeights[i];
+            countScratch[to] = bodyCounts[i];
+        }
+
+        std::copy(bodyScratch.begin() + first, bodyScratch.begin() + first + count, bodies.begin() + first);
+        std::copy(positionScratch.begin() + first, positionScratch.begin() + first + count, bodyPositions.begin() + first);
+        std::copy(weightScratch.begin() + first, weightScratch.begin() + first + count, bodyWeights.begin() + first);
+        std::copy(countScratch.begin() + first, countScratch.begin() + first + count, bodyCounts.begin() + first);
+
+        // the non-empty octants become children, side by side
+        Vrui::Scalar size = cells[cell].size / 2;
+        int firstChild = cells.size();
+
+        for(int octant = 0; octant < 8; octant++)
+        {
+            if(octants[octant] == 0) continue;
+
+            Cell child;
+            child.size = size;
+            child.center = center;
+            child.center[0] += (octant & 1 ? 0.5 : -0.5) * size;
+            child.center[1] += (octant & 2 ? 0.5 : -0.5) * size;
+            child.center[2] += (octant & 4 ? 0.5 : -0.5) * size;
+            cells.push_back(child);
+        }
+
+        cells[cell].firstChild = firstChild;
+        cells[cell].childCount = cells.size() - firstChild;
+
+        int child = firstChild;
+
+        for(int octant = 0; octant < 8; octant++)
+        {
+            if(octants[octant] == 0) continue;
+
+            build(child++, starts[octant], octants[octant], depth + 1);
+        }
+    }
+
+    // sums over the bodies below, from the children's sums if there are any
+    Vrui::Vector sum = Vrui::Vector(0, 0, 0);
+    Vrui::Vector weightedSum = Vrui::Vector(0, 0, 0);
+    Vrui::Scalar bodyCount = 0;
+    Vrui::Scalar weight = 0;
+
+    if(cells[cell].childCount > 0)
+    {
+        for(int i = cells[cell].firstChild; i < cells[cell].firstChild + cells[cell].childCount; i++)
+        {
+            const Cell& c = cells[i];
+            sum += (c.centroid - Vrui::Point::origin) * c.count;
+            weightedSum += (c.weightedCentroid - Vrui::Point::origin) * c.weight;
+            bodyCount += c.count;
+            weight += c.weight;
+        }
+    }
+    else
+    {
+        for(int i = first; i < first + count; i++)
+        {
+            Vrui::Vector v = bodyPositions[i] - Vrui::Point::origin;
+            sum += v * bodyCounts[i];
+            weightedSum += v * bodyWeights[i];
+            bodyCount += bodyCounts[i];
+            weight += bodyWeights[i];
+        }
+    }
+
+    Cell& c = cells[cell];
+    c.count = bodyCount;
+    c.weight = weight;
+    c.centroid = Vrui::Point::origin + sum / bodyCount;
+    c.weightedCentroid = weight > 0 ? Vrui::Point::origin + weightedSum / weight : c.centroid;
+}
+
+void Octree::clear()
+{
+    cells.clear();
+    bodies.clear();
+    bodyPositions.clear();
+    bodyWeights.clear();
+    bodyCounts.clear();
+}
+
+const vector<Octree::Cell>& Octree::getCells() const
+{
+    return cells;
+}
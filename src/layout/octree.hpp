@@ -0,0 +1,128 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __OCTREE_HPP
+#define __OCTREE_HPP
+
+#include <mycelia.hpp>
+
+/*
+ * Barnes-Hut octree over node positions. Each cell keeps the number of bodies
+ * below it and their total weight, with the centroid of each. A body can count
+ * for more than one node, see build(). visit() walks
+ * the tree from a point, handing the visitor whole cells that look small from
+ * there and single bodies otherwise, so a sum over every body costs
+ * O(log N) instead of O(N).
+ *
+ * A cell is summarized when size / distance < openingAngle. 0 visits every
+ * body; around 1 is fast and still close.
+ */
+class Octree
+{
+public:
+    class Cell
+    {
+    public:
+        Vrui::Point center; // of the cube
+        Vrui::Scalar size;  // edge length of the cube
+        Vrui::Point centroid;
+        Vrui::Point weightedCentroid;
+        Vrui::Scalar count;
+        Vrui::Scalar weight;
+
+        // children are cells[firstChild, firstChild + childCount), a leaf has
+        // none and owns bodies[firstBody, firstBody + bodyCount) instead
+        int firstChild;
+        int childCount;
+        int firstBody;
+        int bodyCount;
+    };
+
+    static const int LEAF_SIZE = 8;
+    static const int MAX_DEPTH = 24; // coincident bodies stop splitting here
+
+private:
+    std::vector<Cell> cells;
+    std::vector<int> bodies; // slots, grouped by leaf
+    std::vector<Vrui::Point> bodyPositions;
+    std::vector<Vrui::Scalar> bodyWeights;
+    std::vector<Vrui::Scalar> bodyCounts;
+
+    // build() sorts bodies by octant through these
+    std::vector<int> octantScratch;
+    std::vector<int> bodyScratch;
+    std::vector<Vrui::Point> positionScratch;
+    std::vector<Vrui::Scalar> weightScratch;
+    std::vector<Vrui::Scalar> countScratch;
+
+    void build(int, int, int, int);
+
+public:
+    void build(const std::vector<Vrui::Point>&, const std::vector<int>&, const std::vector<Vrui::Scalar>&, const std::vector<Vrui::Scalar>& = std::vector<Vrui::Scalar>());
+    void clear();
+    const std::vector<Cell>& getCells() const;
+
+    /*
+     * Calls visitor(centroid, count, weightedCentroid, weight) for each cell
+     * or body that together cover every body but slot, as seen from p. A
+     * cell holding p is always opened.
+     */
+    template <class Visitor>
+    void visit(const Vrui::Point& p, int slot, Vrui::Scalar openingAngle, Visitor& visitor) const
+    {
+        if(cells.empty()) return;
+
+        int stack[MAX_DEPTH * 8 + 8];
+        int top = 0;
+        stack[top++] = 0;
+
+        while(top > 0)
+        {
+            const Cell& c = cells[stack[--top]];
+            Vrui::Scalar half = c.size / 2;
+
+            bool inside = Math::abs(p[0] - c.center[0]) <= half
+                       && Math::abs(p[1] - c.center[1]) <= half
+                       && Math::abs(p[2] - c.center[2]) <= half;
+
+            if(!inside && c.size * c.size < openingAngle * openingAngle * Geometry::sqrDist(p, c.centroid))
+            {
+                visitor(c.centroid, c.count, c.weightedCentroid, c.weight);
+            }
+            else if(c.childCount == 0)
+            {
+                for(int i = c.firstBody; i < c.firstBody + c.bodyCount; i++)
+                {
+                    if(bodies[i] != slot)
+                    {
+                        visitor(bodyPositions[i], bodyCounts[i], bodyPositions[i], bodyWeights[i]);
+                    }
+                }
+            }
+            else
+            {
+                for(int i = c.firstChild; i < c.firstChild + c.childCount; i++)
+                {
+                    stack[top++] = i;
+                }
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <layout/packedforces.hpp>
+#include <layout/packedkernels.hpp>
+
+using namespace std;
+
+/*
+ * the AVX2 kernels are built on their own, see packedforces_avx2.cpp
+ */
+#if defined(__x86_64__) || defined(__i386__)
+#define PACKED_AVX2
+int packedFruchtermanReingoldAvx2(const PackedSpan&, const float*, float, float, float, float, double*);
+int packedArfAvx2(const PackedSpan&, const float*, float, float, float, float, double*);
+int packedInverseSquareAvx2(const PackedSpan&, const float*, double*);
+#endif
+
+static PackedForces::InstructionSet getSupported()
+{
+#if defined(PACKED_AVX2)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) return PackedForces::AVX2;
+#endif
+#if defined(__SSE2__)
+    return PackedForces::SSE2;
+#else
+    return PackedForces::SCALAR;
+#endif
+}
+
+static const PackedForces::InstructionSet supported = getSupported();
+static PackedForces::InstructionSet current = supported;
+
+static PackedSpan getSpan(const PackedPoints& points)
+{
+    PackedSpan s;
+    s.count = points.size();
+
+    if(s.count > 0)
+    {
+        s.x = &points.x[0];
+        s.y = &points.y[0];
+        s.z = &points.z[0];
+        s.w = &points.w[0];
+    }
+
+    return s;
+}
+
+static void toFloats(const Vrui::Point& point, float* p)
+{
+    p[0] = point[0];
+    p[1] = point[1];
+    p[2] = point[2];
+}
+
+static Vrui::Vector toVector(const double* force)
+{
+    return Vrui::Vector(force[0], force[1], force[2]);
+}
+
+PackedForces::InstructionSet PackedForces::getInstructionSet()
+{
+    return current;
+}
+
+// for comparing them, can't go past what the processor has
+void PackedForces::setInstructionSet(InstructionSet instructionSet)
+{
+    current = std::min(instructionSet, supported);
+}
+
+Vrui::Vector PackedForces::fruchtermanReingold(const Vrui::Point& point, Vrui::Scalar weight, const PackedPoints& points, Vrui::Scalar k2, Vrui::Scalar radius, Vrui::Scalar cutoff)
+{
+    PackedSpan s = getSpan(points);
+    float p[3];
+    toFloats(point, p);
+    double force[3] = {0, 0, 0};
+    int i = 0;
+    float cutoff2 = cutoff * cutoff; // infinite if cutoff is
+
+#if defined(PACKED_AVX2)
+    if(current == AVX2) i = packedFruchtermanReingoldAvx2(s, p, weight, k2, 1 / radius, cutoff2, force);
+#endif
+#if defined(__SSE2__)
+    if(current >= SSE2) i = packedFruchtermanReingold<SseLanes>(s, i, p, weight, k2, 1 / radius, cutoff2, force);
+#endif
+    packedFruchtermanReingold<ScalarLanes>(s, i, p, weight, k2, 1 / radius, cutoff2, force);
+
+    return toVector(force);
+}
+
+Vrui::Vector PackedForces::arf(const Vrui::Point& point, const PackedPoints& points, Vrui::Scalar springConstant, Vrui::Scalar springLength, Vrui::Scalar repulsion, Vrui::Scalar exponent)
+{
+    PackedSpan s = getSpan(points);
+    float p[3];
+    toFloats(point, p);
+    double force[3] = {0, 0, 0};
+    int i = 0;
+
+#if defined(PACKED_AVX2)
+    if(current == AVX2) i = packedArfAvx2(s, p, springConstant, springLength, repulsion, exponent, force);
+#endif
+#if defined(__SSE2__)
+    if(current >= SSE2) i = packedArf<SseLanes>(s, i, p, springConstant, springLength, repulsion, exponent, force);
+#endif
+    packedArf<ScalarLanes>(s, i, p, springConstant, springLength, repulsion, exponent, force);
+
+    return toVector(force);
+}
+
+Vrui::Vector PackedForces::inverseSquare(const Vrui::Point& point, const PackedPoints& points)
+{
+    PackedSpan s = getSpan(points);
+    float p[3];
+    toFloats(point, p);
+    double force[3] = {0, 0, 0};
+    int i = 0;
+
+#if defined(PACKED_AVX2)
+    if(current == AVX2) i = packedInverseSquareAvx2(s, p, force);
+#endif
+#if defined(__SSE2__)
+    if(current >= SSE2) i = packedInverseSquare<SseLanes>(s, i, p, force);
+#endif
+    packedInverseSquare<ScalarLanes>(s, i, p, force);
+
+    return toVector(force);
+}
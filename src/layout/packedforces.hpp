@@ -0,0 +1,89 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PACKEDFORCES_HPP
+#define __PACKEDFORCES_HPP
+
+#include <mycelia.hpp>
+#include <limits>
+
+/*
+ * Points and weights as four float arrays, so the PackedForces kernels can
+ * load several at once.
+ */
+class PackedPoints
+{
+public:
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> w;
+
+    void clear()
+    {
+        x.clear();
+        y.clear();
+        z.clear();
+        w.clear();
+    }
+
+    void push_back(const Vrui::Point& p, Vrui::Scalar weight)
+    {
+        x.push_back(p[0]);
+        y.push_back(p[1]);
+        z.push_back(p[2]);
+        w.push_back(weight);
+    }
+
+    void set(int i, const Vrui::Point& p)
+    {
+        x[i] = p[0];
+        y[i] = p[1];
+        z[i] = p[2];
+    }
+
+    const int size() const
+    {
+        return x.size();
+    }
+};
+
+/*
+ * Force sums of one point over a PackedPoints in float, on the widest
+ * instruction set the processor has (AVX2, SSE2 or none). Points at the same
+ * position as p are skipped.
+ */
+namespace PackedForces
+{
+enum InstructionSet { SCALAR, SSE2, AVX2 };
+
+InstructionSet getInstructionSet();
+void setInstructionSet(InstructionSet);
+
+// sum of (weight + w) * k2 * (1 / d - d^2 / radius) over the points closer than
+// cutoff, see FruchtermanReingoldLayout
+Vrui::Vector fruchtermanReingold(const Vrui::Point&, Vrui::Scalar weight, const PackedPoints&, Vrui::Scalar k2, Vrui::Scalar radius, Vrui::Scalar cutoff = std::numeric_limits<Vrui::Scalar>::infinity());
+
+// sum of w * (springConstant * (d - springLength) / d + repulsion / d^exponent), see ArfLayout
+Vrui::Vector arf(const Vrui::Point&, const PackedPoints&, Vrui::Scalar springConstant, Vrui::Scalar springLength, Vrui::Scalar repulsion, Vrui::Scalar exponent);
+
+// sum of 1 / d^2 towards each point, see EdgeBundler
+Vrui::Vector inverseSquare(const Vrui::Point&, const PackedPoints&);
+}
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// built with -mavx2 and only called once PackedForces has seen the processor
+// has it, so this includes nothing but the kernels
+
+#include <layout/packedkernels.hpp>
+
+#if defined(__AVX2__)
+
+int packedFruchtermanReingoldAvx2(const PackedSpan& s, const float* p, float weight, float k2, float inverseRadius, float cutoff2, double* force)
+{
+    return packedFruchtermanReingold<AvxLanes>(s, 0, p, weight, k2, inverseRadius, cutoff2, force);
+}
+
+int packedArfAvx2(const PackedSpan& s, const float* p, float springConstant, float springLength, float repulsion, float exponent, double* force)
+{
+    return packedArf<AvxLanes>(s, 0, p, springConstant, springLength, repulsion, exponent, force);
+}
+
+int packedInverseSquareAvx2(const PackedSpan& s, const float* p, double* force)
+{
+    return packedInverseSquare<AvxLanes>(s, 0, p, force);
+}
+
+#endif
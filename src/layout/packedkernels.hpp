@@ -0,0 +1,316 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PACKEDKERNELS_HPP
+#define __PACKEDKERNELS_HPP
+
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*
+ * The loops behind PackedForces, written once over a set of float lanes and
+ * included by one source file per instruction set, each compiled for its own
+ * target. Everything but PackedSpan has internal linkage so the linker can't
+ * hand a caller the copy built for another instruction set. Only raw arrays
+ * cross this boundary for the same reason.
+ */
+// a run of packed points, see PackedPoints
+struct PackedSpan
+{
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* w;
+    int count;
+};
+
+namespace
+{
+
+class ScalarLanes
+{
+public:
+    typedef float V;
+    typedef bool M;
+    static const int WIDTH = 1;
+
+    static V load(const float* p) { return *p; }
+    static V set(float f) { return f; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V div(V a, V b) { return a / b; }
+    static V sqrt(V a) { return std::sqrt(a); }
+    static M greater(V a, V b) { return a > b; }
+    static V keep(M m, V a) { return m ? a : 0; }
+    static V power(V a, float e) { return std::pow(a, e); }
+    static float sum(V a) { return a; }
+};
+
+/*
+ * log2() and exp2() for power() on packed lanes, good to a few ulp for the
+ * positive, normal inputs the kernels give them. log2 splits off the exponent
+ * and takes atanh series of the mantissa; exp2 rounds off the integer part
+ * and takes a Taylor series of the rest.
+ */
+#define PACKED_LOG2E 1.44269504088896341f
+#define PACKED_LN2 0.693147180559945309f
+
+#if defined(__SSE2__)
+class SseLanes
+{
+public:
+    typedef __m128 V;
+    typedef __m128 M;
+    static const int WIDTH = 4;
+
+    static V load(const float* p) { return _mm_loadu_ps(p); }
+    static V set(float f) { return _mm_set1_ps(f); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm_div_ps(a, b); }
+    static V sqrt(V a) { return _mm_sqrt_ps(a); }
+    static M greater(V a, V b) { return _mm_cmpgt_ps(a, b); }
+    static V keep(M m, V a) { return _mm_and_ps(m, a); }
+
+    static float sum(V a)
+    {
+        a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+        a = _mm_add_ss(a, _mm_shuffle_ps(a, a, 1));
+        return _mm_cvtss_f32(a);
+    }
+
+    static V log2(V a)
+    {
+        __m128i bits = _mm_castps_si128(a);
+        V e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+        V m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+
+        // keep the mantissa in [sqrt(1/2), sqrt(2)) so the series converges fast
+        M big = _mm_cmpgt_ps(m, set(1.41421356f));
+        m = _mm_sub_ps(m, _mm_and_ps(big, _mm_mul_ps(m, set(0.5f))));
+        e = _mm_add_ps(e, _mm_and_ps(big, set(1)));
+
+        V t = div(sub(m, set(1)), add(m, set(1)));
+        V t2 = mul(t, t);
+        V s = add(set(1.0f / 7), mul(t2, set(1.0f / 9)));
+        s = add(set(1.0f / 5), mul(t2, s));
+        s = add(set(1.0f / 3), mul(t2, s));
+        s = add(set(1), mul(t2, s));
+        return add(e, mul(mul(t, s), set(2 * PACKED_LOG2E)));
+    }
+
+    static V exp2(V a)
+    {
+        a = _mm_min_ps(_mm_max_ps(a, set(-126)), set(126));
+        __m128i n = _mm_cvtps_epi32(a);
+        V f = mul(sub(a, _mm_cvtepi32_ps(n)), set(PACKED_LN2));
+
+        V p = add(set(1.0f / 720), mul(f, set(1.0f / 5040)));
+        p = add(set(1.0f / 120), mul(f, p));
+        p = add(set(1.0f / 24), mul(f, p));
+        p = add(set(1.0f / 6), mul(f, p));
+        p = add(set(0.5f), mul(f, p));
+        p = add(set(1), mul(f, p));
+        p = add(set(1), mul(f, p));
+        return mul(p, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23)));
+    }
+
+    static V power(V a, float e) { return exp2(mul(log2(a), set(e))); }
+};
+#endif
+
+#if defined(__AVX2__)
+class AvxLanes
+{
+public:
+    typedef __m256 V;
+    typedef __m256 M;
+    static const int WIDTH = 8;
+
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static V set(float f) { return _mm256_set1_ps(f); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+    static M greater(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static V keep(M m, V a) { return _mm256_and_ps(m, a); }
+
+    static float sum(V a)
+    {
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+        return _mm_cvtss_f32(s);
+    }
+
+    // see SseLanes
+    static V log2(V a)
+    {
+        __m256i bits = _mm256_castps_si256(a);
+        V e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+        V m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000)));
+
+        M big = greater(m, set(1.41421356f));
+        m = _mm256_sub_ps(m, _mm256_and_ps(big, _mm256_mul_ps(m, set(0.5f))));
+        e = _mm256_add_ps(e, _mm256_and_ps(big, set(1)));
+
+        V t = div(sub(m, set(1)), add(m, set(1)));
+        V t2 = mul(t, t);
+        V s = add(set(1.0f / 7), mul(t2, set(1.0f / 9)));
+        s = add(set(1.0f / 5), mul(t2, s));
+        s = add(set(1.0f / 3), mul(t2, s));
+        s = add(set(1), mul(t2, s));
+        return add(e, mul(mul(t, s), set(2 * PACKED_LOG2E)));
+    }
+
+    static V exp2(V a)
+    {
+        a = _mm256_min_ps(_mm256_max_ps(a, set(-126)), set(126));
+        __m256i n = _mm256_cvtps_epi32(a);
+        V f = mul(sub(a, _mm256_cvtepi32_ps(n)), set(PACKED_LN2));
+
+        V p = add(set(1.0f / 720), mul(f, set(1.0f / 5040)));
+        p = add(set(1.0f / 120), mul(f, p));
+        p = add(set(1.0f / 24), mul(f, p));
+        p = add(set(1.0f / 6), mul(f, p));
+        p = add(set(0.5f), mul(f, p));
+        p = add(set(1), mul(f, p));
+        p = add(set(1), mul(f, p));
+        return mul(p, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127)), 23)));
+    }
+
+    static V power(V a, float e) { return exp2(mul(log2(a), set(e))); }
+};
+#endif
+
+/*
+ * Each kernel sums the force on a point p from points [first, last) of a
+ * span into force[0..2], skipping points at p, and returns the first point
+ * it didn't get to (the tail that doesn't fill a set of lanes).
+ */
+
+// (weight + w) * k2 * (1 / d - d^2 / radius) along p - q, for d^2 < cutoff2
+template <class L>
+int packedFruchtermanReingold(const PackedSpan& s, int first, const float* p, float weight, float k2, float inverseRadius, float cutoff2, double* force)
+{
+    typedef typename L::V V;
+    V px = L::set(p[0]), py = L::set(p[1]), pz = L::set(p[2]);
+    V fx = L::set(0), fy = L::set(0), fz = L::set(0);
+    int i = first;
+
+    for(; i + L::WIDTH <= s.count; i += L::WIDTH)
+    {
+        V dx = L::sub(px, L::load(s.x + i));
+        V dy = L::sub(py, L::load(s.y + i));
+        V dz = L::sub(pz, L::load(s.z + i));
+        V d2 = L::add(L::add(L::mul(dx, dx), L::mul(dy, dy)), L::mul(dz, dz));
+        V d = L::sqrt(d2);
+
+        V f = L::sub(L::div(L::set(1), d2), L::mul(d, L::set(inverseRadius)));
+        f = L::mul(f, L::mul(L::add(L::set(weight), L::load(s.w + i)), L::set(k2)));
+        f = L::keep(L::greater(d2, L::set(0)), f);
+        f = L::keep(L::greater(L::set(cutoff2), d2), f);
+
+        fx = L::add(fx, L::mul(f, dx));
+        fy = L::add(fy, L::mul(f, dy));
+        fz = L::add(fz, L::mul(f, dz));
+    }
+
+    force[0] += L::sum(fx);
+    force[1] += L::sum(fy);
+    force[2] += L::sum(fz);
+    return i;
+}
+
+// w * (springConstant * (d - springLength) / d + repulsion / d^exponent) along p - q
+template <class L>
+int packedArf(const PackedSpan& s, int first, const float* p, float springConstant, float springLength, float repulsion, float exponent, double* force)
+{
+    typedef typename L::V V;
+    V px = L::set(p[0]), py = L::set(p[1]), pz = L::set(p[2]);
+    V fx = L::set(0), fy = L::set(0), fz = L::set(0);
+    int i = first;
+
+    for(; i + L::WIDTH <= s.count; i += L::WIDTH)
+    {
+        V dx = L::sub(px, L::load(s.x + i));
+        V dy = L::sub(py, L::load(s.y + i));
+        V dz = L::sub(pz, L::load(s.z + i));
+        V d2 = L::add(L::add(L::mul(dx, dx), L::mul(dy, dy)), L::mul(dz, dz));
+        V d = L::sqrt(d2);
+
+        V spring = L::div(L::mul(L::set(springConstant), L::sub(d, L::set(springLength))), d);
+        V repel = L::mul(L::set(repulsion), L::power(d, -exponent));
+        V f = L::mul(L::add(spring, repel), L::load(s.w + i));
+        f = L::keep(L::greater(d2, L::set(0)), f);
+
+        fx = L::add(fx, L::mul(f, dx));
+        fy = L::add(fy, L::mul(f, dy));
+        fz = L::add(fz, L::mul(f, dz));
+    }
+
+    force[0] += L::sum(fx);
+    force[1] += L::sum(fy);
+    force[2] += L::sum(fz);
+    return i;
+}
+
+// 1 / d^2 along q - p
+template <class L>
+int packedInverseSquare(const PackedSpan& s, int first, const float* p, double* force)
+{
+    typedef typename L::V V;
+    V px = L::set(p[0]), py = L::set(p[1]), pz = L::set(p[2]);
+    V fx = L::set(0), fy = L::set(0), fz = L::set(0);
+    int i = first;
+
+    for(; i + L::WIDTH <= s.count; i += L::WIDTH)
+    {
+        V dx = L::sub(L::load(s.x + i), px);
+        V dy = L::sub(L::load(s.y + i), py);
+        V dz = L::sub(L::load(s.z + i), pz);
+        V d2 = L::add(L::add(L::mul(dx, dx), L::mul(dy, dy)), L::mul(dz, dz));
+
+        V f = L::div(L::set(1), L::mul(d2, L::sqrt(d2)));
+        f = L::keep(L::greater(d2, L::set(0)), f);
+
+        fx = L::add(fx, L::mul(f, dx));
+        fy = L::add(fy, L::mul(f, dy));
+        fz = L::add(fz, L::mul(f, dz));
+    }
+
+    force[0] += L::sum(fx);
+    force[1] += L::sum(fy);
+    force[2] += L::sum(fz);
+    return i;
+}
+
+}
+
+#endif
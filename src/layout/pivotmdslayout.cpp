@@ -0,0 +1,407 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <layout/pivotmdslayout.hpp>
+
+#include <climits>
+
+using namespace std;
+
+#define JITTER 0.2 // hops
+
+PivotMdsLayout::PivotMdsLayout(Mycelia* application)
+    : GraphLayout(application)
+{
+}
+
+void* PivotMdsLayout::layout()
+{
+    place(application->g, SEED_RADIUS);
+    
+    stopped = true;
+    application->resetNavigationCallback(0);
+    
+    return 0;
+}
+
+/*
+ * Places the active nodes within radius of the origin, the rest keep still.
+ */
+void PivotMdsLayout::place(Graph* g, Vrui::Scalar radius)
+{
+    place(g, radius, placeComponent);
+}
+
+// as above, each component placed by placer
+void PivotMdsLayout::place(Graph* g, Vrui::Scalar radius, ComponentPlacer placer)
+{
+    boost::shared_ptr<const Adjacency> adjacency = g->getAdjacency();
+    boost::shared_ptr<const ActiveNodes> active = g->getActiveNodes();
+    vector<Vrui::Point> positions;
+    g->getNodePositions(positions);
+    int nodeCount = std::min(positions.size(), adjacency->inOffsets.size());
+    
+    // the components, one after the other in breadth first order
+    vector<int> members;                // slots
+    vector<int> starts;                 // of each component in members, then the end
+    vector<int> indexes(nodeCount, -1); // in members, by slot
+    
+    foreach(int slot, active->slots)
+    {
+        if(slot >= nodeCount || indexes[slot] != -1) continue;
+        
+        starts.push_back(members.size());
+        indexes[slot] = members.size();
+        members.push_back(slot);
+        
+        for(int i = starts.back(); i < (int)members.size(); i++)
+        {
+            int source = members[i];
+            
+            for(int index = adjacency->offsets[source]; index < adjacency->offsets[source + 1]; index++)
+            {
+                int target = adjacency->neighbors[index];
+                
+                if(target >= nodeCount || !active->isActive(target) || indexes[target] != -1)
+                {
+                    continue;
+                }
+                
+                indexes[target] = members.size();
+                members.push_back(target);
+            }
+        }
+    }
+    
+    int componentCount = starts.size();
+    starts.push_back(members.size());
+    
+    if(componentCount == 0) return;
+    
+    // where the nodes are, then around their component's center in hops
+    vector<Vrui::Point> points(members.size());
+    vector<Vrui::Scalar> radii(componentCount);
+    vector<pair<int, int> > order; // (-size, component)
+    
+    for(int i = 0; i < (int)members.size(); i++)
+    {
+        points[i] = positions[members[i]];
+    }
+    
+    for(int c = 0; c < componentCount; c++)
+    {
+        radii[c] = placer(*adjacency, members, starts[c], starts[c + 1], indexes, points);
+        order.push_back(pair<int, int>(starts[c] - starts[c + 1], c));
+    }
+    
+    std::sort(order.begin(), order.end());
+    
+    // the largest component in the middle, the rest evenly over a sphere big
+    // enough to hold them
+    vector<Vrui::Vector> centers(componentCount, Vrui::Vector(0, 0, 0));
+    Vrui::Scalar largest = radii[order[0].second];
+    Vrui::Scalar outer = 0;
+    Vrui::Scalar area = 0;
+    
+    for(int i = 1; i < componentCount; i++)
+    {
+        Vrui::Scalar r = radii[order[i].second] + 1;
+        outer = std::max(outer, r);
+        area += r * r;
+    }
+    
+    Vrui::Scalar shell = std::max(largest + outer, Math::sqrt(area / 2));
+    
+    for(int i = 1; i < componentCount; i++)
+    {
+        Vrui::Scalar z = 1 - 2 * (i - 0.5) / (componentCount - 1);
+        Vrui::Scalar r = Math::sqrt(1 - z * z);
+        Vrui::Scalar angle = 2.39996 * i; // golden angle
+        centers[order[i].second] = Vrui::Vector(r * Math::cos(angle), r * Math::sin(angle), z) * shell;
+    }
+    
+    Vrui::Scalar extent = 0;
+    
+    for(int c = 0; c < componentCount; c++)
+    {
+        for(int i = starts[c]; i < starts[c + 1]; i++)
+        {
+            points[i] += centers[c];
+            extent = std::max(extent, Geometry::mag(points[i] - Vrui::Point::origin));
+        }
+    }
+    
+    Vrui::Scalar scale = extent > 0 ? radius / extent : 1;
+    vector<Vrui::Vector> deltas(nodeCount, Vrui::Vector(0, 0, 0));
+    
+    for(int i = 0; i < (int)members.size(); i++)
+    {
+        int slot = members[i];
+        deltas[slot] = Vrui::Point::origin + (points[i] - Vrui::Point::origin) * scale - positions[slot];
+    }
+    
+    g->updateNodePositions(deltas);
+}
+
+/*
+ * Places members[first, last), one component, into points around the origin
+ * with an edge about one long and returns its radius. indexes maps slots to
+ * members, points starts out at their positions.
+ */
+const Vrui::Scalar PivotMdsLayout::placeComponent(const Adjacency& adjacency, const vector<int>& members, int first, int last, const vector<int>& indexes, vector<Vrui::Point>& points)
+{
+    int n = last - first;
+    int k = std::min(PIVOTS, n);
+    
+    // the component's own adjacency, by index from first, so the searches
+    // below don't go through slots
+    vector<int> offsets(n + 1, 0);
+    vector<int> neighbors;
+    
+    for(int i = 0; i < n; i++)
+    {
+        int source = members[first + i];
+        
+        for(int index = adjacency.offsets[source]; index < adjacency.offsets[source + 1]; index++)
+        {
+            int target = adjacency.neighbors[index];
+            if(target >= (int)indexes.size() || indexes[target] == -1 || target == source) continue;
+            
+            neighbors.push_back(indexes[target] - first);
+        }
+        
+        offsets[i + 1] = neighbors.size();
+    }
+    
+    // distances[i * k + p] is the hops from pivot p to node i, nearest[i] the
+    // hops to the closest pivot so far
+    vector<unsigned short> distances(n * k);
+    vector<int> nearest(n, INT_MAX);
+    vector<int> hops(n);
+    vector<int> queue(n);
+    
+    // the first pivot is the best connected node
+    int pivot = 0;
+    
+    for(int i = 1; i < n; i++)
+    {
+        if(offsets[i + 1] - offsets[i] > offsets[pivot + 1] - offsets[pivot]) pivot = i;
+    }
+    
+    for(int p = 0; p < k; p++)
+    {
+        hops.assign(n, -1);
+        hops[pivot] = 0;
+        queue[0] = pivot;
+        int tail = 1;
+        
+        for(int head = 0; head < tail; head++)
+        {
+            int i = queue[head];
+            
+            for(int index = offsets[i]; index < offsets[i + 1]; index++)
+            {
+                int j = neighbors[index];
+                if(hops[j] != -1) continue;
+                
+                hops[j] = hops[i] + 1;
+                queue[tail++] = j;
+            }
+        }
+        
+        // the next pivot is the node farthest from all of them
+        int farthest = 0;
+        
+        for(int i = 0; i < n; i++)
+        {
+            distances[i * k + p] = std::min(hops[i], (int)USHRT_MAX);
+            nearest[i] = std::min(nearest[i], hops[i]);
+            if(nearest[i] > nearest[farthest]) farthest = i;
+        }
+        
+        pivot = farthest;
+    }
+    
+    // double centering of the squared distances, b[i][p] =
+    // -(d^2 - mean of row i - mean of column p + mean of all) / 2
+    vector<double> rowMeans(n, 0);
+    vector<double> columnMeans(k, 0);
+    double mean = 0;
+    
+    for(int i = 0; i < n; i++)
+    {
+        for(int p = 0; p < k; p++)
+        {
+            double d2 = (double)distances[i * k + p] * distances[i * k + p];
+            rowMeans[i] += d2 / k;
+            columnMeans[p] += d2 / n;
+            mean += d2 / ((double)n * k);
+        }
+    }
+    
+    // b^T b, whose main eigenvectors are the axes
+    vector<double> product(k * k, 0);
+    vector<double> row(k);
+    
+    for(int i = 0; i < n; i++)
+    {
+        for(int p = 0; p < k; p++)
+        {
+            double d2 = (double)distances[i * k + p] * distances[i * k + p];
+            row[p] = -(d2 - rowMeans[i] - columnMeans[p] + mean) / 2;
+        }
+        
+        for(int p = 0; p < k; p++)
+        {
+            for(int q = p; q < k; q++)
+            {
+                product[p * k + q] += row[p] * row[q];
+            }
+        }
+    }
+    
+    for(int p = 0; p < k; p++)
+    {
+        for(int q = 0; q < p; q++)
+        {
+            product[p * k + q] = product[q * k + p];
+        }
+    }
+    
+    // power iteration, each axis kept orthogonal to the ones before it; a
+    // component that is flatter than 3d gets zero axes
+    vector<double> axes(3 * k, 0);
+    vector<double> next(k);
+    double largest = 0;
+    
+    for(int d = 0; d < 3; d++)
+    {
+        double* axis = &axes[d * k];
+        
+        for(int p = 0; p < k; p++)
+        {
+            axis[p] = Math::cos(p * (d + 1) + 1.0);
+        }
+        
+        for(int iteration = 0; iteration < 100; iteration++)
+        {
+            for(int p = 0; p < k; p++)
+            {
+                next[p] = 0;
+                
+                for(int q = 0; q < k; q++)
+                {
+                    next[p] += product[p * k + q] * axis[q];
+                }
+            }
+            
+            for(int e = 0; e < d; e++)
+            {
+                double dot = 0;
+                for(int p = 0; p < k; p++) dot += next[p] * axes[e * k + p];
+                for(int p = 0; p < k; p++) next[p] -= dot * axes[e * k + p];
+            }
+            
+            double norm = 0;
+            for(int p = 0; p < k; p++) norm += next[p] * next[p];
+            norm = Math::sqrt(norm);
+            
+            if(d == 0) largest = norm;
+            
+            if(norm <= 1e-9 * largest || norm == 0)
+            {
+                std::fill(axis, axis + k, 0.0);
+                break;
+            }
+            
+            for(int p = 0; p < k; p++)
+            {
+                axis[p] = next[p] / norm;
+            }
+        }
+    }
+    
+    // coordinates are b times the axes
+    for(int i = 0; i < n; i++)
+    {
+        for(int p = 0; p < k; p++)
+        {
+            double d2 = (double)distances[i * k + p] * distances[i * k + p];
+            row[p] = -(d2 - rowMeans[i] - columnMeans[p] + mean) / 2;
+        }
+        
+        Vrui::Point& point = points[first + i];
+        
+        for(int d = 0; d < 3; d++)
+        {
+            double x = 0;
+            for(int p = 0; p < k; p++) x += row[p] * axes[d * k + p];
+            point[d] = x;
+        }
+    }
+    
+    return fitComponent(offsets, neighbors, members, first, last, points);
+}
+
+/*
+ * Scales points[first, last) to edges of about one, pulls apart nodes that
+ * landed on each other, centers them and returns their radius. offsets and
+ * neighbors are the component's adjacency, by index from first.
+ */
+const Vrui::Scalar PivotMdsLayout::fitComponent(const vector<int>& offsets, const vector<int>& neighbors, const vector<int>& members, int first, int last, vector<Vrui::Point>& points)
+{
+    int n = last - first;
+    double length = 0;
+    
+    for(int i = 0; i < n; i++)
+    {
+        for(int index = offsets[i]; index < offsets[i + 1]; index++)
+        {
+            length += Geometry::dist(points[first + i], points[first + neighbors[index]]);
+        }
+    }
+    
+    Vrui::Scalar scale = length > 0 ? neighbors.size() / length : 1;
+    Vrui::Vector center(0, 0, 0);
+    
+    for(int i = first; i < last; i++)
+    {
+        unsigned int hash = members[i] * 2654435761u;
+        Vrui::Vector jitter;
+        
+        for(int d = 0; d < 3; d++)
+        {
+            hash = hash * 1664525u + 1013904223u;
+            jitter[d] = ((hash >> 8) / 16777216.0 - 0.5) * JITTER;
+        }
+        
+        points[i] = Vrui::Point::origin + (points[i] - Vrui::Point::origin) * scale + jitter;
+        center += points[i] - Vrui::Point::origin;
+    }
+    
+    center /= n;
+    Vrui::Scalar radius = 0;
+    
+    for(int i = first; i < last; i++)
+    {
+        points[i] -= center;
+        radius = std::max(radius, Geometry::mag(points[i] - Vrui::Point::origin));
+    }
+    
+    return radius;
+}
@@ -0,0 +1,61 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PIVOTMDSLAYOUT_HPP
+#define __PIVOTMDSLAYOUT_HPP
+
+#include <graph.hpp>
+#include <mycelia.hpp>
+#include <layout/graphlayout.hpp>
+
+#define PIVOTS 32
+#define SEED_RADIUS 100
+
+/*
+ * Places nodes by classical scaling of their hop distances to a few pivot
+ * nodes (Brandes and Pich's PivotMDS): each pivot is the node farthest from
+ * those picked before it, one breadth-first search from each gives every node
+ * a row of PIVOTS distances, and the three main axes of those rows are its
+ * coordinates. That costs O(PIVOTS * (N + E)) and the same graph always lands
+ * the same way.
+ *
+ * Each connected component is placed on its own; the largest sits in the
+ * middle and the rest spread over a sphere around it. place() is where the
+ * other layouts start from, and the layout on its own is a rough one for
+ * graphs too big to iterate on. Subclasses can place components their own
+ * way, see ComponentPlacer.
+ */
+class PivotMdsLayout : public GraphLayout
+{
+public:
+    PivotMdsLayout(Mycelia*);
+
+    static void place(Graph*, Vrui::Scalar);
+
+protected:
+    // places one component, see placeComponent()
+    typedef const Vrui::Scalar (*ComponentPlacer)(const Adjacency&, const std::vector<int>&, int, int, const std::vector<int>&, std::vector<Vrui::Point>&);
+
+    static const Vrui::Scalar placeComponent(const Adjacency&, const std::vector<int>&, int, int, const std::vector<int>&, std::vector<Vrui::Point>&);
+    static const Vrui::Scalar fitComponent(const std::vector<int>&, const std::vector<int>&, const std::vector<int>&, int, int, std::vector<Vrui::Point>&);
+    static void place(Graph*, Vrui::Scalar, ComponentPlacer);
+
+    virtual void* layout();
+};
+
+#endif
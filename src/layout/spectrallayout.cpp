@@ -0,0 +1,424 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <layout/spectrallayout.hpp>
+
+using namespace std;
+
+namespace
+{
+typedef vector<double> Column;
+
+/*
+ * The weighted Laplacian D - W of one component, by index in the component.
+ */
+class Laplacian
+{
+public:
+    vector<int> offsets;
+    vector<int> neighbors;
+    vector<double> weights;
+    vector<double> degrees; // weighted
+
+    const int size() const
+    {
+        return degrees.size();
+    }
+
+    void multiply(const Column& x, Column& y) const
+    {
+        y.resize(size());
+
+        for(int i = 0; i < size(); i++)
+        {
+            double sum = degrees[i] * x[i];
+
+            for(int index = offsets[i]; index < offsets[i + 1]; index++)
+            {
+                sum -= weights[index] * x[neighbors[index]];
+            }
+
+            y[i] = sum;
+        }
+    }
+};
+
+double dot(const Column& a, const Column& b)
+{
+    double sum = 0;
+    for(int i = 0; i < (int)a.size(); i++) sum += a[i] * b[i];
+    return sum;
+}
+
+// y += a * x
+void add(double a, const Column& x, Column& y)
+{
+    for(int i = 0; i < (int)x.size(); i++) y[i] += a * x[i];
+}
+
+void scale(double a, Column& x)
+{
+    for(int i = 0; i < (int)x.size(); i++) x[i] *= a;
+}
+
+// the constant vector is the trivial eigenvector, everything stays orthogonal to it
+void removeMean(Column& x)
+{
+    double mean = 0;
+    for(int i = 0; i < (int)x.size(); i++) mean += x[i];
+    mean /= x.size();
+    for(int i = 0; i < (int)x.size(); i++) x[i] -= mean;
+}
+
+/*
+ * Appends what is left of x after taking out basis, at unit length, unless
+ * that is next to nothing. If images holds L times each of basis, ax is L
+ * times x and goes along.
+ */
+bool extend(vector<Column>& basis, vector<Column>* images, Column x, Column* ax)
+{
+    double length = Math::sqrt(dot(x, x));
+    double before = length;
+    double left = length;
+    if(length == 0) return false;
+
+    // a second pass if most of x cancelled out, rounding leaves some of basis
+    // in what is left
+    for(int pass = 0; pass < 2; pass++)
+    {
+        for(int j = 0; j < (int)basis.size(); j++)
+        {
+            double d = dot(x, basis[j]);
+            add(-d, basis[j], x);
+            if(ax) add(-d, (*images)[j], *ax);
+        }
+
+        left = Math::sqrt(dot(x, x));
+        if(left >= before / 2) break;
+
+        before = left;
+    }
+
+    if(left < 1e-10 * length) return false;
+
+    scale(1 / left, x);
+    basis.push_back(x);
+
+    if(ax)
+    {
+        scale(1 / left, *ax);
+        images->push_back(*ax);
+    }
+
+    return true;
+}
+
+/*
+ * Eigenvalues of the symmetric m x m matrix a, ascending, and their
+ * eigenvectors as the columns of vectors, both row major, by Jacobi rotations.
+ * a is used up.
+ */
+void eigen(vector<double>& a, int m, vector<double>& values, vector<double>& vectors)
+{
+    vector<double> v(m * m, 0);
+    for(int i = 0; i < m; i++) v[i * m + i] = 1;
+
+    for(int sweep = 0; sweep < 50; sweep++)
+    {
+        double off = 0;
+        double all = 0;
+
+        for(int i = 0; i < m * m; i++)
+        {
+            all += a[i] * a[i];
+            if(i / m != i % m) off += a[i] * a[i];
+        }
+
+        if(off <= 1e-24 * all) break;
+
+        for(int p = 0; p < m; p++)
+        {
+            for(int q = p + 1; q < m; q++)
+            {
+                if(a[p * m + q] == 0) continue;
+
+                double theta = (a[q * m + q] - a[p * m + p]) / (2 * a[p * m + q]);
+                double t = (theta >= 0 ? 1 : -1) / (Math::abs(theta) + Math::sqrt(theta * theta + 1));
+                double c = 1 / Math::sqrt(t * t + 1);
+                double s = t * c;
+
+                for(int k = 0; k < m; k++)
+                {
+                    double kp = a[k * m + p];
+                    double kq = a[k * m + q];
+                    a[k * m + p] = c * kp - s * kq;
+                    a[k * m + q] = s * kp + c * kq;
+                }
+
+                for(int k = 0; k < m; k++)
+                {
+                    double pk = a[p * m + k];
+                    double qk = a[q * m + k];
+                    a[p * m + k] = c * pk - s * qk;
+                    a[q * m + k] = s * pk + c * qk;
+                }
+
+                for(int k = 0; k < m; k++)
+                {
+                    double kp = v[k * m + p];
+                    double kq = v[k * m + q];
+                    v[k * m + p] = c * kp - s * kq;
+                    v[k * m + q] = s * kp + c * kq;
+                }
+            }
+        }
+    }
+
+    vector<pair<double, int> > order;
+    for(int i = 0; i < m; i++) order.push_back(pair<double, int>(a[i * m + i], i));
+    std::sort(order.begin(), order.end());
+
+    values.resize(m);
+    vectors.resize(m * m);
+
+    for(int j = 0; j < m; j++)
+    {
+        values[j] = order[j].first;
+        for(int i = 0; i < m; i++) vectors[i * m + j] = v[i * m + order[j].second];
+    }
+}
+
+/*
+ * Replaces x (and ax = L x) by the best combinations of basis (and images),
+ * x[j] being the jth smallest; p gets their part outside the first
+ * x.size() columns of basis. Returns the Ritz values.
+ */
+vector<double> rayleighRitz(const vector<Column>& basis, const vector<Column>& images, vector<Column>& x, vector<Column>& ax, vector<Column>* p, vector<Column>* ap)
+{
+    int m = basis.size();
+    int b = x.size();
+    int n = basis[0].size();
+    vector<double> gram(m * m);
+
+    for(int i = 0; i < m; i++)
+    {
+        for(int j = i; j < m; j++)
+        {
+            gram[i * m + j] = gram[j * m + i] = dot(basis[i], images[j]);
+        }
+    }
+
+    vector<double> values;
+    vector<double> vectors;
+    eigen(gram, m, values, vectors);
+
+    for(int j = 0; j < b; j++)
+    {
+        x[j].assign(n, 0);
+        ax[j].assign(n, 0);
+
+        if(p)
+        {
+            (*p)[j].assign(n, 0);
+            (*ap)[j].assign(n, 0);
+        }
+
+        for(int i = 0; i < m; i++)
+        {
+            double c = vectors[i * m + j];
+            add(c, basis[i], x[j]);
+            add(c, images[i], ax[j]);
+
+            if(p && i >= b)
+            {
+                add(c, basis[i], (*p)[j]);
+                add(c, images[i], (*ap)[j]);
+            }
+        }
+    }
+
+    values.resize(b);
+    return values;
+}
+}
+
+SpectralLayout::SpectralLayout(Mycelia* application)
+    : PivotMdsLayout(application)
+{
+}
+
+void* SpectralLayout::layout()
+{
+    place(application->g, SEED_RADIUS, placeComponent);
+    
+    stopped = true;
+    application->resetNavigationCallback(0);
+    
+    return 0;
+}
+
+/*
+ * Places members[first, last) like PivotMdsLayout::placeComponent(), at the
+ * eigenvectors of the component's Laplacian.
+ */
+const Vrui::Scalar SpectralLayout::placeComponent(const Adjacency& adjacency, const vector<int>& members, int first, int last, const vector<int>& indexes, vector<Vrui::Point>& points)
+{
+    int n = last - first;
+    
+    if(n < SPECTRAL_MIN_SIZE)
+    {
+        return PivotMdsLayout::placeComponent(adjacency, members, first, last, indexes, points);
+    }
+    
+    // edges without a positive weight are left out, the pivot placement has
+    // all of them
+    Laplacian laplacian;
+    vector<int> offsets(n + 1, 0); // of every neighbor, for fitComponent()
+    vector<int> neighbors;
+    laplacian.offsets.assign(n + 1, 0);
+    laplacian.degrees.assign(n, 0);
+    double maxDegree = 0; // twice this bounds the largest eigenvalue
+    
+    for(int i = 0; i < n; i++)
+    {
+        int source = members[first + i];
+        
+        for(int index = adjacency.offsets[source]; index < adjacency.offsets[source + 1]; index++)
+        {
+            int target = adjacency.neighbors[index];
+            if(target >= (int)indexes.size() || indexes[target] == -1 || target == source) continue;
+            
+            neighbors.push_back(indexes[target] - first);
+            
+            if(adjacency.weights[index] > 0)
+            {
+                laplacian.neighbors.push_back(indexes[target] - first);
+                laplacian.weights.push_back(adjacency.weights[index]);
+                laplacian.degrees[i] += adjacency.weights[index];
+            }
+        }
+        
+        offsets[i + 1] = neighbors.size();
+        laplacian.offsets[i + 1] = laplacian.neighbors.size();
+        maxDegree = std::max(maxDegree, laplacian.degrees[i]);
+    }
+    
+    // start from where the nodes are, and some noise for the extra vectors
+    int b = SPECTRAL_BLOCK;
+    vector<Column> x;
+    vector<Column> ax(b);
+    
+    for(int j = 0; (int)x.size() < b; j++)
+    {
+        Column start(n);
+        
+        for(int i = 0; i < n; i++)
+        {
+            if(j < 3)
+            {
+                start[i] = points[first + i][j];
+            }
+            else
+            {
+                unsigned int hash = (members[first + i] + j * 7919u) * 2654435761u;
+                start[i] = (hash >> 8) / 16777216.0 - 0.5;
+            }
+        }
+        
+        removeMean(start);
+        extend(x, 0, start, 0);
+    }
+    
+    for(int j = 0; j < b; j++)
+    {
+        laplacian.multiply(x[j], ax[j]);
+    }
+    
+    vector<Column> basis = x;
+    vector<Column> images = ax;
+    vector<double> values = rayleighRitz(basis, images, x, ax, 0, 0);
+    
+    // LOBPCG, each step picks the best of x, the preconditioned residuals and
+    // the last step's direction
+    vector<Column> p;
+    vector<Column> ap;
+    
+    for(int iteration = 0; iteration < SPECTRAL_ITERATIONS; iteration++)
+    {
+        vector<Column> residuals(b);
+        bool converged = true;
+        
+        for(int j = 0; j < b; j++)
+        {
+            residuals[j] = ax[j];
+            add(-values[j], x[j], residuals[j]);
+            
+            // eigenvalues next to 0 are held to the largest one instead, there
+            // are some if leaving out edges split the component
+            double tolerance = SPECTRAL_TOLERANCE * std::max(values[j], 1e-9 * 2 * maxDegree);
+            
+            if(j < 3 && Math::sqrt(dot(residuals[j], residuals[j])) > tolerance)
+            {
+                converged = false;
+            }
+        }
+        
+        if(converged) break;
+        
+        basis.swap(x);
+        images.swap(ax);
+        x.resize(b);
+        ax.resize(b);
+        
+        for(int j = 0; j < (int)p.size(); j++)
+        {
+            extend(basis, &images, p[j], &ap[j]);
+        }
+        
+        int known = basis.size();
+        
+        for(int j = 0; j < b; j++)
+        {
+            for(int i = 0; i < n; i++)
+            {
+                if(laplacian.degrees[i] > 0) residuals[j][i] /= laplacian.degrees[i];
+            }
+            
+            removeMean(residuals[j]);
+            extend(basis, 0, residuals[j], 0);
+        }
+        
+        images.resize(basis.size());
+        
+        for(int j = known; j < (int)basis.size(); j++)
+        {
+            laplacian.multiply(basis[j], images[j]);
+        }
+        
+        p.resize(b);
+        ap.resize(b);
+        values = rayleighRitz(basis, images, x, ax, &p, &ap);
+    }
+    
+    for(int i = 0; i < n; i++)
+    {
+        points[first + i] = Vrui::Point(x[0][i], x[1][i], x[2][i]);
+    }
+    
+    return fitComponent(offsets, neighbors, members, first, last, points);
+}
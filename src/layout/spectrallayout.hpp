@@ -0,0 +1,52 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SPECTRALLAYOUT_HPP
+#define __SPECTRALLAYOUT_HPP
+
+#include <graph.hpp>
+#include <mycelia.hpp>
+#include <layout/pivotmdslayout.hpp>
+
+#define SPECTRAL_BLOCK 4          // eigenvectors iterated together, the first 3 are kept
+#define SPECTRAL_ITERATIONS 1000
+#define SPECTRAL_TOLERANCE 0.05   // of a residual, relative to its eigenvalue
+#define SPECTRAL_MIN_SIZE 16      // smaller components keep their pivot placement
+
+/*
+ * Places each component at its 2nd to 4th smallest Laplacian eigenvectors,
+ * which put neighbors close and spread everything else out, in one go. The
+ * eigenvectors are found by LOBPCG (Knyazev's locally optimal block
+ * preconditioned conjugate gradient) with a degree preconditioner, starting
+ * from where the nodes are, so from the pivot placement after a reset; each
+ * iteration costs a sparse product per block vector. Lattices, hypercubes
+ * and other regular graphs come out close to how they are drawn by hand.
+ */
+class SpectralLayout : public PivotMdsLayout
+{
+private:
+    static const Vrui::Scalar placeComponent(const Adjacency&, const std::vector<int>&, int, int, const std::vector<int>&, std::vector<Vrui::Point>&);
+
+public:
+    SpectralLayout(Mycelia*);
+
+protected:
+    virtual void* layout();
+};
+
+#endif
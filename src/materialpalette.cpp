@@ -0,0 +1,129 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <materialpalette.hpp>
+
+using namespace std;
+
+MaterialPalette::MaterialPalette()
+    : pinnedCount(0)
+{
+}
+
+unsigned int MaterialPalette::pack(const GLMaterial::Color& c)
+{
+    unsigned int key = 0;
+
+    for(int i = 0; i < 4; i++)
+    {
+        float channel = std::max(0.0f, std::min(1.0f, (float)c[i]));
+        key = (key << 8) | (unsigned int)(channel * 255 + 0.5);
+    }
+
+    return key;
+}
+
+// returns the id for color c, adding a material if there isn't one yet
+const int MaterialPalette::acquire(const GLMaterial::Color& c)
+{
+    unsigned int key = pack(c);
+    tr1::unordered_map<unsigned int, int>::iterator i = ids.find(key);
+
+    if(i != ids.end())
+    {
+        acquire(i->second);
+        return i->second;
+    }
+
+    int id;
+
+    if(freeIds.empty())
+    {
+        id = materials.size();
+        materials.push_back(GLMaterial(c));
+        keys.push_back(key);
+        references.push_back(1);
+    }
+    else
+    {
+        id = freeIds.back();
+        freeIds.pop_back();
+        materials[id] = GLMaterial(c);
+        keys[id] = key;
+        references[id] = 1;
+    }
+
+    ids[key] = id;
+    return id;
+}
+
+void MaterialPalette::acquire(int id)
+{
+    if(id >= pinnedCount && isValid(id))
+    {
+        references[id]++;
+    }
+}
+
+void MaterialPalette::release(int id)
+{
+    if(id < pinnedCount || !isValid(id))
+    {
+        return;
+    }
+
+    if(--references[id] == 0)
+    {
+        ids.erase(keys[id]);
+        freeIds.push_back(id);
+    }
+}
+
+// adds a material that is never released, only valid before any acquire
+const int MaterialPalette::pin(const GLMaterial::Color& c)
+{
+    unsigned int key = pack(c);
+    int id = materials.size();
+
+    materials.push_back(GLMaterial(c));
+    keys.push_back(key);
+    references.push_back(1);
+    pinnedCount = materials.size();
+
+    if(ids.find(key) == ids.end())
+    {
+        ids[key] = id;
+    }
+
+    return id;
+}
+
+const GLMaterial& MaterialPalette::getMaterial(int id) const
+{
+    return materials[id];
+}
+
+const bool MaterialPalette::isValid(int id) const
+{
+    return id >= 0 && id < (int)materials.size() && references[id] > 0;
+}
+
+const int MaterialPalette::getSize() const
+{
+    return materials.size() - freeIds.size();
+}
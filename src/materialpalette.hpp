@@ -0,0 +1,55 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MATERIALPALETTE_HPP
+#define __MATERIALPALETTE_HPP
+
+#include <mycelia.hpp>
+
+/*
+ * Interns materials by color. Colors are quantized to 8 bits per channel and
+ * packed into one hash key, so looking one up is O(1). Ids are reference
+ * counted and recycled once nothing uses them, except for the first
+ * pinnedCount ids, which stay forever.
+ */
+class MaterialPalette
+{
+private:
+    std::vector<GLMaterial> materials; // id -> material
+    std::vector<unsigned int> keys;    // id -> packed color
+    std::vector<int> references;       // id -> users
+    std::vector<int> freeIds;
+    std::tr1::unordered_map<unsigned int, int> ids; // packed color -> id
+    int pinnedCount;
+
+    static unsigned int pack(const GLMaterial::Color&);
+
+public:
+    MaterialPalette();
+
+    const int acquire(const GLMaterial::Color&);
+    void acquire(int);
+    void release(int);
+    const int pin(const GLMaterial::Color&);
+
+    const GLMaterial& getMaterial(int) const;
+    const bool isValid(int) const;
+    const int getSize() const;
+};
+
+#endif
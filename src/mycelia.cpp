@@ -31,6 +31,10 @@
 #include <layout/edgebundler.hpp>
 #include <layout/frlayout.hpp>
 #include <layout/graphlayout.hpp>
+#include <layout/incrementallayout.hpp>
+#include <layout/multilevellayout.hpp>
+#include <layout/pivotmdslayout.hpp>
+#include <layout/spectrallayout.hpp>
 #include <parsers/chacoparser.hpp>
 #include <parsers/dotparser.hpp>
 #include <parsers/gmlparser.hpp>
@@ -82,6 +86,10 @@ Mycelia::Mycelia(int argc, char** argv, char** appDefaults)
     // node layout / edge bundler
     dynamicLayout = new ArfLayout(this);
     staticLayout = new FruchtermanReingoldLayout(this);
+    multilevelLayout = new MultilevelLayout(this);
+    roughLayout = new PivotMdsLayout(this);
+    spectralLayout = new SpectralLayout(this);
+    incrementalLayout = new IncrementalLayout(this);
     edgeBundler = new EdgeBundler(this);
     skipLayout = false;
 
@@ -121,6 +129,10 @@ Mycelia::Mycelia(int argc, char** argv, char** appDefaults)
 
     staticButton = new GLMotif::ToggleButton("StaticButton", layoutRadioBox, "Static");
     dynamicButton = new GLMotif::ToggleButton("DynamicButton", layoutRadioBox, "Dynamic");
+    multilevelButton = new GLMotif::ToggleButton("MultilevelButton", layoutRadioBox, "Multilevel");
+    roughButton = new GLMotif::ToggleButton("RoughButton", layoutRadioBox, "Rough");
+    spectralButton = new GLMotif::ToggleButton("SpectralButton", layoutRadioBox, "Spectral");
+    incrementalButton = new GLMotif::ToggleButton("IncrementalButton", layoutRadioBox, "Incremental");
     layout = staticLayout;
 
     // render submenu
@@ -289,24 +301,157 @@ void Mycelia::buildGraphList(MyceliaDataItem* dataItem) const
     gluQuadricOrientation(dataItem->quadric, GLU_OUTSIDE);
     glEndList();
 
+    int slotCount = gCopy->getAdjacency()->inOffsets.size();
+    dataItem->resizeNodeLists((slotCount + NODES_PER_LIST - 1) / NODES_PER_LIST);
+
+    for(int list = 0; list < (int)dataItem->nodeLists.size(); list++)
+    {
+        buildNodeList(dataItem, list);
+    }
+
     glNewList(dataItem->graphList, GL_COMPILE);
 
+    foreach(GLuint list, dataItem->nodeLists)
+    {
+        glCallList(list);
+    }
+
+    if(bundleButton->getToggle())
+    {
+        drawBundledEdges(dataItem);
+    }
+
+    glEndList();
+}
+
+// the active nodes in one run of NODES_PER_LIST slots, and their out-edges
+void Mycelia::buildNodeList(MyceliaDataItem* dataItem, int list) const
+{
+    boost::shared_ptr<const Adjacency> adjacency = gCopy->getAdjacency();
+    boost::shared_ptr<const ActiveNodes> active = gCopy->getActiveNodes();
+    int first = list * NODES_PER_LIST;
+    int last = std::min(first + NODES_PER_LIST, (int)adjacency->inOffsets.size());
+
     // Camera aligned texture nodes cannot be part of the display list since
     // we must readjust their orientation anytime we are rotating the graph.
-    if (gCopy->getTextureNodeMode() == "align")
+    bool images = gCopy->getTextureNodeMode() != "align";
+
+    glNewList(dataItem->nodeLists[list], GL_COMPILE);
+
+    for(int slot = first; slot < last; slot++)
     {
-        std::string filter = "image";
-        drawNodes(dataItem, filter);
+        if(!active->isActive(slot)) continue;
+
+        int node = adjacency->nodes[slot];
+
+        if(gCopy->getNodeType(node) != NODE_IMAGE || images)
+        {
+            drawNode(node, dataItem);
+        }
     }
-    else
+
+    if(!bundleButton->getToggle())
     {
-        drawNodes(dataItem);
+        drawEdges(dataItem, first, last);
     }
 
-    drawEdges(dataItem);
     glEndList();
 }
 
+// marks the list of slot, and with neighbors those of the nodes it shares
+// an edge with, since their edges end at it
+static void markNodeList(const Adjacency& adjacency, int slot, bool neighbors, vector<bool>& dirty)
+{
+    if(slot >= (int)adjacency.inOffsets.size()) return;
+
+    dirty[slot / NODES_PER_LIST] = true;
+
+    if(!neighbors) return;
+
+    for(int index = adjacency.offsets[slot]; index < adjacency.offsets[slot + 1]; index++)
+    {
+        dirty[adjacency.neighbors[index] / NODES_PER_LIST] = true;
+    }
+}
+
+/*
+ * Rebuilds just the node lists that dataItem->changes touch, so moving or
+ * restyling a few nodes costs a few lists rather than the whole graph. Returns
+ * false if the changes call for buildGraphList() instead: no lists built yet,
+ * a reload or redraw, every node moved or restyled, a node removed (the last
+ * slot takes its place), or bundled edges, which are drawn all at once.
+ */
+const bool Mycelia::updateGraphList(MyceliaDataItem* dataItem) const
+{
+    const ChangeSet& changes = dataItem->changes;
+
+    if(dataItem->nodeLists.empty() || changes.isEmpty() || changes.reload || changes.redrawn
+       || changes.allPositions || changes.allStyles || bundleButton->getToggle())
+    {
+        return false;
+    }
+
+    foreach(const Change& c, changes.structure)
+    {
+        if(c.kind == ChangeLog::NODE_REMOVED) return false;
+    }
+
+    boost::shared_ptr<const Adjacency> adjacency = gCopy->getAdjacency();
+    int oldCount = dataItem->nodeLists.size();
+    int listCount = (adjacency->inOffsets.size() + NODES_PER_LIST - 1) / NODES_PER_LIST;
+
+    if(listCount < oldCount) return false;
+
+    // update version first in case of preemption
+    dataItem->graphListVersion = gCopy->getVersion();
+
+    vector<bool> dirty(listCount, false);
+    const vector<bool>* nodeMarks[3] = {&changes.positions, &changes.nodeStyles, &changes.topology};
+
+    for(int i = 0; i < 3; i++)
+    {
+        for(int node = 0; node < (int)nodeMarks[i]->size(); node++)
+        {
+            if((*nodeMarks[i])[node] && gCopy->isValidNode(node))
+            {
+                markNodeList(*adjacency, gCopy->getNodeSlot(node), true, dirty);
+            }
+        }
+    }
+
+    for(int edge = 0; edge < (int)changes.edgeStyles.size(); edge++)
+    {
+        if(!changes.edgeStyles[edge] || !gCopy->isValidEdge(edge)) continue;
+
+        const Edge& e = gCopy->getEdge(edge);
+        markNodeList(*adjacency, gCopy->getNodeSlot(e.source), false, dirty);
+        markNodeList(*adjacency, gCopy->getNodeSlot(e.target), false, dirty);
+    }
+
+    dataItem->resizeNodeLists(listCount);
+
+    for(int list = 0; list < listCount; list++)
+    {
+        if(dirty[list] || list >= oldCount) buildNodeList(dataItem, list);
+    }
+
+    // the graph list only calls the node lists, so it's unchanged unless
+    // there are more of them
+    if(listCount > oldCount)
+    {
+        glNewList(dataItem->graphList, GL_COMPILE);
+
+        foreach(GLuint list, dataItem->nodeLists)
+        {
+            glCallList(list);
+        }
+
+        glEndList();
+    }
+
+    return true;
+}
+
 void Mycelia::drawEdge(const Edge& edge, MyceliaDataItem* dataItem) const
 {
     drawEdge(gCopy->getNodePosition(edge.source),
@@ -373,42 +518,68 @@ void Mycelia::drawEdge(const Vrui::Point& source,
     glPopMatrix();
 }
 
-void Mycelia::drawEdges(MyceliaDataItem* dataItem) const
+void Mycelia::drawBundledEdges(MyceliaDataItem* dataItem) const
 {
-    /*
-    we don't draw an edge if one was already drawn between two nodes.
-    this saves lots of time for very dense graphs.
-    todo: the current approach to tracking drawn edges is a quick hack.
-    */
-    bool drawn[1000][1000] = {{false}};
-
     const GLMaterial *material;
     Vrui::Scalar width;
 
-    foreach(int edge, gCopy->getEdges())
+    vector<int> edges;
+    gCopy->getActiveEdges(edges);
+
+    foreach(int edge, edges)
     {
         const Edge& e = gCopy->getEdge(edge);
-
-        if(!isSelectedComponent(e.source) || drawn[e.source][e.target])
+        material = gCopy->getEdgeMaterial(edge);
+        width = edgeThickness * e.weight;
+        int slot = gCopy->getEdgeSlot(edge);
+        for(int segment = 0; segment <= edgeBundler->getSegmentCount(); segment++)
         {
-            continue;
+            const Vrui::Point& p = *edgeBundler->getSegment(slot, segment);
+            const Vrui::Point& q = *edgeBundler->getSegment(slot, segment + 1);
+            drawEdge(p, q, material, width, false, false, dataItem);
         }
+    }
+}
+
+// the out-edges of the active sources in slots [first, last)
+void Mycelia::drawEdges(MyceliaDataItem* dataItem, int first, int last) const
+{
+    /*
+    we don't draw an edge if one was already drawn between two nodes.
+    this saves lots of time for very dense graphs. each source's out-edges
+    are contiguous in the adjacency, so drawn only has to remember the last
+    source that reached each target, and is put back to -1 after each source
+    so it can be kept from one list to the next.
+    */
+    boost::shared_ptr<const Adjacency> adjacency = gCopy->getAdjacency();
+    boost::shared_ptr<const ActiveNodes> active = gCopy->getActiveNodes();
+    vector<int>& drawn = dataItem->drawn;
+
+    if(drawn.size() < adjacency->inOffsets.size())
+    {
+        drawn.resize(adjacency->inOffsets.size(), -1);
+    }
 
-        if(bundleButton->getToggle())
+    for(int source = first; source < last; source++)
+    {
+        if(!active->isActive(source)) continue;
+
+        for(int index = adjacency->offsets[source]; index < adjacency->inOffsets[source]; index++)
         {
-            material = gCopy->getEdgeMaterial(edge);
-            width = edgeThickness * e.weight;
-            for(int segment = 0; segment <= edgeBundler->getSegmentCount(); segment++)
+            int target = adjacency->neighbors[index];
+
+            if(drawn[target] == source || !active->isActive(target))
             {
-                const Vrui::Point& p = *edgeBundler->getSegment(edge, segment);
-                const Vrui::Point& q = *edgeBundler->getSegment(edge, segment + 1);
-                drawEdge(p, q, material, width, false, false, dataItem);
+                continue;
             }
+
+            drawEdge(gCopy->getEdge(adjacency->edges[index]), dataItem);
+            drawn[target] = source;
         }
-        else
+
+        for(int index = adjacency->offsets[source]; index < adjacency->inOffsets[source]; index++)
         {
-            drawEdge(e, dataItem);
-            drawn[e.source][e.target] = true;
+            drawn[adjacency->neighbors[index]] = -1;
         }
     }
 }
@@ -428,13 +599,11 @@ void Mycelia::drawEdgeLabels(MyceliaDataItem* dataItem) const
 
     float scale = nodeRadius * FONT_MODIFIER;
 
-    foreach(int edge, gCopy->getEdges())
-    {
-        if(!isSelectedComponent(gCopy->getEdge(edge).source))
-        {
-            continue;
-        }
+    vector<int> edges;
+    gCopy->getActiveEdges(edges);
 
+    foreach(int edge, edges)
+    {
         const string& label = gCopy->getEdgeLabel(edge);
 
         if(label.size() > 0)
@@ -582,32 +751,27 @@ bool Mycelia::drawShapeNode(int node, MyceliaDataItem* dataItem) const
 
 void Mycelia::drawNode(int node, MyceliaDataItem* dataItem) const
 {
-    std::string type = gCopy->getNodeType(node);
+    NodeType type = gCopy->getNodeType(node);
 
     bool success = false;
-    if (type == "image")
+    if (type == NODE_IMAGE)
     {
         success = drawTextureNode(node, dataItem);
     }
 
-    if (type == "shape" || !success)
+    if (type == NODE_SHAPE || !success)
     {
         success = drawShapeNode(node, dataItem);
     }
 }
 
-void Mycelia::drawNodes(MyceliaDataItem* dataItem, std::string filter) const
+// draws the active nodes of the chosen types
+void Mycelia::drawNodes(MyceliaDataItem* dataItem, bool shapes, bool images) const
 {
-    std::string node_type;
-    foreach(int node, gCopy->getNodes())
+    boost::shared_ptr<const ActiveNodes> active = gCopy->getActiveNodes();
+    foreach(int node, active->nodes)
     {
-        if(!isSelectedComponent(node))
-        {
-            continue;
-        }
-
-        node_type = gCopy->getNodeType(node);
-        if (node_type != filter)
+        if (gCopy->getNodeType(node) == NODE_IMAGE ? images : shapes)
         {
             drawNode(node, dataItem);
         }
@@ -629,13 +793,10 @@ void Mycelia::drawNodeLabels(MyceliaDataItem* dataItem) const
 
     float scale = nodeRadius * FONT_MODIFIER;
 
-    foreach(int node, gCopy->getNodes())
-    {
-        if(!isSelectedComponent(node))
-        {
-            continue;
-        }
+    boost::shared_ptr<const ActiveNodes> active = gCopy->getActiveNodes();
 
+    foreach(int node, active->nodes)
+    {
         const Vrui::Point& p = gCopy->getNodePosition(node);
         const string& label = gCopy->getNodeLabel(node);
 
@@ -666,7 +827,7 @@ void Mycelia::drawShortestPath(MyceliaDataItem* dataItem) const
 
     for(int i = selectedNode; i != previousNode; i = predecessorVector[i])
     {
-        if(i == predecessorVector[i]) break;
+        if(i >= (int)predecessorVector.size() || i == predecessorVector[i]) break;
 
         drawNode(i, dataItem);
         Edge e(i, predecessorVector[i]);
@@ -679,8 +840,11 @@ void Mycelia::drawSpanningTree(MyceliaDataItem* dataItem) const
 {
     glMaterial(GLMaterialEnums::FRONT_AND_BACK, *gCopy->getNodeMaterialFromId(MATERIAL_SELECTED));
 
+    // indexed by id, deleted nodes have no predecessor
     for(int i = 0; i < (int)predecessorVector.size(); i++)
     {
+        if(predecessorVector[i] < 0 || !gCopy->isValidNode(i) || !gCopy->isValidNode(predecessorVector[i])) continue;
+
         drawNode(i, dataItem);
         Edge e(i, predecessorVector[i]);
         drawEdge(e, const_cast<MyceliaDataItem*>(dataItem) );
@@ -701,7 +865,20 @@ void Mycelia::display(GLContextData& contextData) const
     // re-create display list if it's been updated
     if(dataItem->graphListVersion != gCopy->getVersion())
     {
-        buildGraphList(dataItem);
+        ChangeSet& changes = dataItem->changes;
+        dataItem->graphListChanges = gCopy->getChanges(dataItem->graphListChanges, changes);
+
+        // labels are drawn every frame and attributes not at all, so changes
+        // to just those leave the list as it is
+        if(!changes.isEmpty() && !changes.redrawn && !changes.hasPositions()
+           && !changes.hasStyles() && !changes.hasTopology())
+        {
+            dataItem->graphListVersion = gCopy->getVersion();
+        }
+        else if(!updateGraphList(dataItem))
+        {
+            buildGraphList(dataItem);
+        }
     }
 
     if(spanningTreeButton->getToggle())
@@ -717,8 +894,7 @@ void Mycelia::display(GLContextData& contextData) const
         // will rotate so long as we don't redraw the display list.
         if (gCopy->getTextureNodeMode() == "align")
         {
-            std::string filter = "shape";
-            drawNodes(dataItem, filter);
+            drawNodes(dataItem, false, true);
         }
 
         // Haven't figure out what FTGLTextureFont::Render() is changing...
@@ -747,10 +923,9 @@ double Mycelia::getNodeEdgeOffset(int node, MyceliaDataItem* dataItem) const
 
     double offset = nodeRadius;
 
-    std::string type = gCopy->getNodeType(node);
-    if (type == "image")
+    if (gCopy->getNodeType(node) == NODE_IMAGE)
     {
-        std::string imagePath = gCopy->getNodeImagePath(node);
+        const std::string& imagePath = gCopy->getNodeImagePath(node);
         std::pair<GLuint, std::pair<float, float> > texturePair = dataItem->getTextureId(imagePath);
         GLuint imageId = texturePair.first;
         if (imageId != 0)
@@ -779,9 +954,7 @@ void Mycelia::frame()
     rotationAngle = Math::mod(rotationAngle, Vrui::Scalar(360));
     lastFrameTime = newFrameTime;
 
-    g->lock();
-    *gCopy = *g;
-    g->unlock();
+    gCopy->acquireSnapshot(*g);
 
     if(gCopy->getNodeCount() == 0)
     {
@@ -828,14 +1001,16 @@ void Mycelia::initContext(GLContextData& contextData) const
     contextData.addDataItem(this, dataItem);
 }
 
-bool Mycelia::isSelectedComponent(int node) const
+void Mycelia::focusSelectedComponent()
 {
-    if(componentButton->getToggle())
+    if(componentButton->getToggle() && g->isValidNode(selectedNode))
     {
-        return gCopy->getNodeComponent(node) == gCopy->getNodeComponent(selectedNode);
+        g->setFocus(g->getNodeComponent(selectedNode));
+    }
+    else
+    {
+        g->setFocus(FOCUS_ALL);
     }
-
-    return true;
 }
 
 void Mycelia::setStatus(const char* status) const
@@ -900,6 +1075,50 @@ void Mycelia::setLayoutType(int type)
         layout = staticLayout;
         layoutWindow->hide();
     }
+    else if(type == LAYOUT_MULTILEVEL)
+    {
+        layoutRadioBox->setSelectedToggle(2);
+        if (layout != multilevelLayout)
+        {
+            // Then we are switching layouts!
+            stopLayout();
+        }
+        layout = multilevelLayout;
+        layoutWindow->hide();
+    }
+    else if(type == LAYOUT_ROUGH)
+    {
+        layoutRadioBox->setSelectedToggle(3);
+        if (layout != roughLayout)
+        {
+            // Then we are switching layouts!
+            stopLayout();
+        }
+        layout = roughLayout;
+        layoutWindow->hide();
+    }
+    else if(type == LAYOUT_SPECTRAL)
+    {
+        layoutRadioBox->setSelectedToggle(4);
+        if (layout != spectralLayout)
+        {
+            // Then we are switching layouts!
+            stopLayout();
+        }
+        layout = spectralLayout;
+        layoutWindow->hide();
+    }
+    else if(type == LAYOUT_INCREMENTAL)
+    {
+        layoutRadioBox->setSelectedToggle(5);
+        if (layout != incrementalLayout)
+        {
+            // Then we are switching layouts!
+            stopLayout();
+        }
+        layout = incrementalLayout;
+        layoutWindow->hide();
+    }
 }
 
 void Mycelia::setSkipLayout(bool skipLayout)
@@ -917,6 +1136,10 @@ void Mycelia::stopLayout() const
     edgeBundler->stop();
     staticLayout->stop();
     dynamicLayout->stop();
+    multilevelLayout->stop();
+    roughLayout->stop();
+    spectralLayout->stop();
+    incrementalLayout->stop();
 }
 
 /*
@@ -934,7 +1157,7 @@ void Mycelia::bundleCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cb
     else
     {
         edgeBundler->stop();
-        g->update();
+        g->redraw();
         resumeLayout();
     }
 }
@@ -974,6 +1197,7 @@ void Mycelia::componentCallback(GLMotif::ToggleButton::ValueChangedCallbackData*
         g->setComponents();
     }
 
+    focusSelectedComponent();
     resetLayoutCallback(0);
 }
 
@@ -1007,6 +1231,12 @@ void Mycelia::fileOpen(string &filename)
         gmlParser->parse(filename);
     }
 
+    if(g->getEdgeCount() > 0)
+    {
+        cout << g->getNodeCount() << " nodes, " << g->getEdgeCount() << " edges, "
+             << g->getAdjacencyBytes() / g->getEdgeCount() << " adjacency bytes/edge" << endl;
+    }
+
     // reset navigation here in case skipLayout is true
     resetNavigationCallback(0);
     resetLayoutCallback(0);
@@ -1099,29 +1329,28 @@ void Mycelia::pythonCallback(GLMotif::RadioBox::ValueChangedCallbackData* cbData
     }
     else if(cbData->newSelectedToggle == adjacencyButton)
     {
-        bool a[1000][1000] = {{false}}; // temporary
+        // the node count, then one "source target" line per nonzero entry,
+        // indexed by slot
+        ofstream out("/tmp/input.txt");
+        boost::shared_ptr<const Adjacency> adjacency = gCopy->getAdjacency();
+        int nodeCount = adjacency->inOffsets.size();
 
-        foreach(int source, gCopy->getNodes())
-        {
-            foreach(int target, gCopy->getNodes())
-            {
-                if(gCopy->hasEdge(source, target))
-                {
-                    a[source][target] = true;
-                }
-            }
-        }
+        vector<int> written(nodeCount, -1); // parallel edges are written once
 
-        ofstream out("/tmp/input.txt");
+        out << nodeCount << endl;
 
-        for(int source = 0; source < gCopy->getNodeCount(); source++)
+        for(int source = 0; source < nodeCount; source++)
         {
-            for(int target = 0; target < gCopy->getNodeCount(); target++)
+            for(int index = adjacency->offsets[source]; index < adjacency->inOffsets[source]; index++)
             {
-                out << a[source][target] << " ";
-            }
+                int target = adjacency->neighbors[index];
 
-            out << endl;
+                if(written[target] != source)
+                {
+                    out << source << " " << target << endl;
+                    written[target] = source;
+                }
+            }
         }
 
         out.close();
@@ -1130,14 +1359,21 @@ void Mycelia::pythonCallback(GLMotif::RadioBox::ValueChangedCallbackData* cbData
     else if(cbData->newSelectedToggle == lanetButton)
     {
         ofstream out("/tmp/input.txt");
+        const vector<int>& nodes = gCopy->getNodes();
+        boost::shared_ptr<const Adjacency> adjacency = gCopy->getAdjacency();
+
+        vector<int> written(nodes.size(), -1); // parallel edges are written once
 
-        foreach(int source, gCopy->getNodes())
+        for(int source = 0; source < gCopy->getNodeCount(); source++)
         {
-            foreach(int target, gCopy->getNodes())
+            for(int index = adjacency->offsets[source]; index < adjacency->inOffsets[source]; index++)
             {
-                if(gCopy->hasEdge(source, target))
+                int target = adjacency->neighbors[index];
+
+                if(written[target] != source)
                 {
-                    out << source << " " << target << endl;
+                    out << nodes[source] << " " << nodes[target] << endl;
+                    written[target] = source;
                 }
             }
         }
@@ -1164,6 +1400,22 @@ void Mycelia::resetLayout(bool watch)
     {
         setLayoutType(LAYOUT_STATIC);
     }
+    else if(multilevelButton->getToggle())
+    {
+        setLayoutType(LAYOUT_MULTILEVEL);
+    }
+    else if(roughButton->getToggle())
+    {
+        setLayoutType(LAYOUT_ROUGH);
+    }
+    else if(spectralButton->getToggle())
+    {
+        setLayoutType(LAYOUT_SPECTRAL);
+    }
+    else if(incrementalButton->getToggle())
+    {
+        setLayoutType(LAYOUT_INCREMENTAL);
+    }
     else
     {
         setLayoutType(LAYOUT_DYNAMIC);
@@ -1177,9 +1429,14 @@ void Mycelia::resetLayout(bool watch)
         return;
     }
 
-    // reset layout state
-    g->randomizePositions(100);
+    // reset layout state, the rough layout is nothing but the starting point
+    // and places the nodes on its own thread
+    if(layout != roughLayout)
+    {
+        PivotMdsLayout::place(g, SEED_RADIUS);
+    }
     g->clearVelocities();
+    incrementalLayout->reset();
 
     // In order to avoid a flicker during layout...let's recenter.
     if (watch)
@@ -1195,28 +1452,32 @@ void Mycelia::resetLayout(bool watch)
     // they have finished laying out the graph.
     startLayout();
 #else
-    // positions
+    // positions, indexed by slot
+    const vector<int>& nodes = g->getNodes();
     float4* positions_h = new float4[size];
+    vector<Vrui::Point> positions;
+    g->getNodePositions(positions);
 
-    foreach(int node, g->getNodes())
+    for(int slot = 0; slot < size; slot++)
     {
-        const Vrui::Point& p = g->getNodePosition(node);
+        const Vrui::Point& p = positions[slot];
         float4 q;
         q.x = p[0];
         q.y = p[1];
         q.z = p[2];
-        q.w = g->getNodeDegree(node);
-        positions_h[node] = q;
+        q.w = g->getNodeDegree(nodes[slot]);
+        positions_h[slot] = q;
     }
 
     // adjacency matrix
-    int* adjacencies_h = new int[size * size];
+    int* adjacencies_h = new int[size * size]();
+    boost::shared_ptr<const Adjacency> adjacency = g->getAdjacency();
 
     for(int row = 0; row < size; row++)
     {
-        for(int col = 0; col < size; col++)
+        for(int index = adjacency->offsets[row]; index < adjacency->inOffsets[row]; index++)
         {
-            adjacencies_h[row * size + col] = g->hasEdge(row, col);
+            adjacencies_h[row * size + adjacency->neighbors[index]] = 1;
         }
     }
 
@@ -1224,10 +1485,10 @@ void Mycelia::resetLayout(bool watch)
     gpuLayout(positions_h, adjacencies_h, size);
 
     // update positions
-    foreach(int node, g->getNodes())
+    for(int slot = 0; slot < size; slot++)
     {
-        const float4& q = positions_h[node];
-        g->setNodePosition(node, Vrui::Point(q.x, q.y, q.z));
+        const float4& q = positions_h[slot];
+        g->setNodePosition(nodes[slot], Vrui::Point(q.x, q.y, q.z));
     }
 
     // free memory
@@ -1257,7 +1518,7 @@ void Mycelia::resetNavigationCallback(Misc::CallbackData* cbData)
 
     Vrui::setNavigationTransformation(Vrui::Point::origin, radius);
 
-    g->update();
+    g->redraw();
     if (layoutWasRunning)
     {
         resumeLayout(); // for dynamic layout
@@ -1300,7 +1561,8 @@ void Mycelia::writeGraphCallback(Misc::CallbackData* cbData)
 void Mycelia::clearSelections()
 {
     previousNode = selectedNode = SELECTION_NONE;
-    g->update();
+    focusSelectedComponent();
+    g->redraw();
 }
 
 int Mycelia::getPreviousNode() const
@@ -1329,8 +1591,9 @@ void Mycelia::setSelectedNode(int node)
     previousNode = selectedNode;
     selectedNode = node;
 
+    focusSelectedComponent();
     shortestPathCallback(0);
-    g->update();
+    g->redraw();
 #ifdef __RPCSERVER__
     server->callback(node);
 #endif
@@ -1341,7 +1604,7 @@ void Mycelia::setHighlightedNode(int node)
     if (node != highlightedNode)
     {
         highlightedNode = node;
-        g->update();
+        g->redraw();
     }
 }
 
@@ -1406,11 +1669,14 @@ int Mycelia::selectNode(const Vrui::Ray& ray) const
     // adjusts properly within other zoom levels.
     float coneAngle2 = Math::asin( Math::sqr(nodeRadius) / Geometry::sqr(ray.getOrigin()) );
     float lambdaMin2 = numeric_limits<float>::max();
+    const vector<int>& nodes = g->getNodes();
+    vector<Vrui::Point> positions;
+    g->getNodePositions(positions);
 
-    foreach(int node, g->getNodes())
+    for(int slot = 0; slot < (int)nodes.size() && slot < (int)positions.size(); slot++)
     {
         // vector pointing from origin to node position
-        Vrui::Vector sp = g->getNodePosition(node) - ray.getOrigin();
+        Vrui::Vector sp = positions[slot] - ray.getOrigin();
         // squared dot product between sp and ray direction
         float x2 = Math::sqr(sp * ray.getDirection());
 
@@ -1462,7 +1728,7 @@ int Mycelia::selectNode(const Vrui::Ray& ray) const
             // for the angle.
             if (y2 / x2 <= coneAngle2)
             {
-                nearest = node;
+                nearest = nodes[slot];
                 lambdaMin2 = x2;
             }
         }
@@ -1495,13 +1761,17 @@ std::pair<int, float> Mycelia::nearestNode(const Vrui::Point& clickPosition) con
     int nearest = SELECTION_NONE;
     float minDist2 = numeric_limits<float>::max();
 
-    foreach(int node, g->getNodes())
+    const vector<int>& nodes = g->getNodes();
+    vector<Vrui::Point> positions;
+    g->getNodePositions(positions);
+
+    for(int slot = 0; slot < (int)nodes.size() && slot < (int)positions.size(); slot++)
     {
-        float dist2 = Geometry::sqrDist(clickPosition, g->getNodePosition(node));
+        float dist2 = Geometry::sqrDist(clickPosition, positions[slot]);
 
         if(dist2 < minDist2)
         {
-            nearest = node;
+            nearest = nodes[slot];
             minDist2 = dist2;
         }
     }
@@ -31,24 +31,40 @@ class Edge;
 class EdgeBundler;
 class ErdosGenerator;
 class FruchtermanReingoldLayout;
+class IncrementalLayout;
 class GmlParser;
 class Graph;
 class GraphGenerator;
 class GraphLayout;
 class ImageWindow;
+class MultilevelLayout;
 class MyceliaDataItem;
+class PivotMdsLayout;
 class RpcServer;
+class SpectralLayout;
 class XmlParser;
 class WattsGenerator;
 
 #define LAYOUT_STATIC 0
 #define LAYOUT_DYNAMIC 1
+#define LAYOUT_MULTILEVEL 2
+#define LAYOUT_ROUGH 3
+#define LAYOUT_SPECTRAL 4
+#define LAYOUT_INCREMENTAL 5
 #define SELECTION_NONE -1
 #define FONT_SIZE 96.0
 #define FONT_MODIFIER 0.04
+#define NODES_PER_LIST 1024
 #define foreach BOOST_FOREACH
 #define PYTHON "/usr/bin/python"
 
+// how a node is drawn, see Graph::setNodeType()
+enum NodeType
+{
+    NODE_SHAPE,
+    NODE_IMAGE
+};
+
 class Mycelia : public Vrui::Application, public GLObject
 {
 private:
@@ -62,6 +78,10 @@ private:
     // layout and bundling
     FruchtermanReingoldLayout* staticLayout;
     ArfLayout* dynamicLayout;
+    MultilevelLayout* multilevelLayout;
+    PivotMdsLayout* roughLayout;
+    SpectralLayout* spectralLayout;
+    IncrementalLayout* incrementalLayout;
     GraphLayout* layout;
     EdgeBundler* edgeBundler;
     bool skipLayout;
@@ -80,6 +100,10 @@ private:
     GLMotif::RadioBox* layoutRadioBox;
     GLMotif::ToggleButton* staticButton;
     GLMotif::ToggleButton* dynamicButton;
+    GLMotif::ToggleButton* multilevelButton;
+    GLMotif::ToggleButton* roughButton;
+    GLMotif::ToggleButton* spectralButton;
+    GLMotif::ToggleButton* incrementalButton;
 
     // gui -- render options
     GLMotif::ToggleButton* bundleButton;
@@ -144,24 +168,27 @@ public:
 
     // graph functions
     void buildGraphList(MyceliaDataItem*) const;
+    void buildNodeList(MyceliaDataItem*, int) const;
+    const bool updateGraphList(MyceliaDataItem*) const;
     void drawEdge(const Edge&, MyceliaDataItem*) const;
     void drawEdge(const Vrui::Point&, const Vrui::Point&,
                   const GLMaterial*, const Vrui::Scalar, bool, bool,
                   MyceliaDataItem*,
                   double sourceEdgeOffset=0, double targetEdgeOffset=0) const;
-    void drawEdges(MyceliaDataItem*) const;
+    void drawBundledEdges(MyceliaDataItem*) const;
+    void drawEdges(MyceliaDataItem*, int, int) const;
     void drawEdgeLabels(MyceliaDataItem*) const;
     void drawLogo(MyceliaDataItem*) const;
     void drawNode(int, MyceliaDataItem*) const;
     bool drawShapeNode(int, MyceliaDataItem*) const;
     bool drawTextureNode(int, MyceliaDataItem*) const;
-    void drawNodes(MyceliaDataItem*, std::string filter="none") const;
+    void drawNodes(MyceliaDataItem*, bool = true, bool = true) const;
     void drawNodeLabels(MyceliaDataItem*) const;
     void drawShortestPath(MyceliaDataItem*) const;
     void drawSpanningTree(MyceliaDataItem*) const;
     void fileOpen(std::string &filename);
     double getNodeEdgeOffset(int node, MyceliaDataItem*) const;
-    bool isSelectedComponent(int) const;
+    void focusSelectedComponent();
 
     // layout functions
     void resetLayout(bool watch=true);
@@ -227,6 +254,9 @@ public:
     Graph* gCopy;
     GLMotif::PopupMenu* getMainMenuPopup() { return mainMenuPopup; }
     ArfLayout* getDynamicLayout() { return dynamicLayout; }
+    FruchtermanReingoldLayout* getStaticLayout() { return staticLayout; }
+    MultilevelLayout* getMultilevelLayout() { return multilevelLayout; }
+    IncrementalLayout* getIncrementalLayout() { return incrementalLayout; }
     void setStatus(const char*) const;
 };
 
@@ -28,34 +28,48 @@ ChacoParser::ChacoParser(Mycelia* application)
 void ChacoParser::parse(string& filename)
 {
     ifstream in(filename.c_str());
-    int nodeCount;
-    int edgeCount;
+    string line;
+    int nodeCount = 0;
+    int edgeCount = 0;
     
-    in >> nodeCount >> edgeCount;
+    // skip comments up to the header
+    while(getline(in, line) && (line.empty() || line[0] == '%'))
+    {
+    }
+    
+    stringstream header(line);
+    header >> nodeCount >> edgeCount;
     cout << nodeCount << " nodes, " << edgeCount << " edges" << endl;
     
+    application->g->beginBatch(nodeCount, edgeCount);
+    
     for(int i = 0; i < nodeCount; i++)
     {
         application->g->addNode();
     }
     
+    // line i lists the neighbors of node i, numbered from 1. getline() has no
+    // length limit, so high degree nodes aren't cut short.
     int sourceNode = 0;
     
-    while(!in.eof())
+    while(sourceNode < nodeCount && getline(in, line))
     {
-        char line[256];
-        in.getline(line, 256);
+        if(!line.empty() && line[0] == '%')
+        {
+            continue;
+        }
         
         stringstream stream(line);
         int targetNode;
         
         while(stream >> targetNode) // only works because space is delimiter
         {
-            application->g->addEdge(sourceNode, targetNode);
+            application->g->addEdge(sourceNode, targetNode - 1);
         }
         
         sourceNode++;
     }
     
+    application->g->commit();
     in.close();
-}
\ No newline at end of file
+}
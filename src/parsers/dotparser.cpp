@@ -45,6 +45,7 @@ void DotParser::parse(string& filename)
     smatch positionMatches;
     smatch labelMatches;
     nodeMap.clear();
+    application->g->beginBatch();
     
     // nodes
     lineStart = fileBuffer.begin();
@@ -115,4 +116,6 @@ void DotParser::parse(string& filename)
         
         lineStart = lineMatches[0].second;
     }
+    
+    application->g->commit();
 }
\ No newline at end of file
@@ -28,6 +28,7 @@ GmlParser::GmlParser(Mycelia* application)
 void GmlParser::parse(string& filename)
 {
     ifstream in(filename.c_str());
+    application->g->beginBatch();
     
     while(!in.eof())
     {
@@ -59,4 +60,6 @@ void GmlParser::parse(string& filename)
             }
         }
     }
+    
+    application->g->commit();
 }
\ No newline at end of file
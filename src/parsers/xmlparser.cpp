@@ -39,6 +39,7 @@ void XmlParser::parse(string& filename)
     string::const_iterator lineStart;
     string::const_iterator lineEnd;
     idMap.clear();
+    application->g->beginBatch();
     
     // colors
     lineStart = fileBuffer.begin();
@@ -172,10 +173,17 @@ void XmlParser::parse(string& filename)
                 application->g->setEdgeLabel(edgeId, value);
             }
             
+            if(key != "from" && key != "to")
+            {
+                application->g->setEdgeAttribute(edgeId, key, value);
+            }
+            
             edgeStart = attributeMatches[0].second;
         }
         
         if(!directed) application->g->addEdge(idMap[target], idMap[source]);
         lineStart = lineMatches[0].second;
     }
+    
+    application->g->commit();
 }
\ No newline at end of file
@@ -0,0 +1,218 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __POSITIONBUFFER_HPP
+#define __POSITIONBUFFER_HPP
+
+#include <mycelia.hpp>
+#include <sched.h>
+
+/*
+ * Node positions, indexed by slot, behind a sequence lock.
+ *
+ * Writers bracket every change with beginWrite() and endWrite(), which makes
+ * the sequence odd for the duration, and must be serialized by the caller
+ * (Graph holds its mutex). Readers never lock: read() copies the whole array
+ * and retries if a write overlapped, so it always returns one complete step.
+ *
+ * Growing swaps in a bigger block but keeps the old one alive until the
+ * buffer is destroyed, so a reader that raced the swap only ever touches
+ * valid memory; capacity doubles, so the retired blocks add up to less than
+ * the live one.
+ */
+class PositionBuffer
+{
+private:
+    struct Block
+    {
+        Vrui::Point* points;
+        int capacity;
+    };
+
+    // __sync_synchronize() is a compiler barrier as well, which is what keeps
+    // these from being cached in registers across the retry loops
+    Block* block;
+    int count;
+    unsigned int sequence;   // odd while a write is in progress
+    unsigned int generation; // bumped when slots are added or removed
+    std::vector<Block*> retired;
+
+    PositionBuffer(const PositionBuffer&);
+    PositionBuffer& operator=(const PositionBuffer&);
+
+    // to at least twice the capacity, whatever was asked for, so a buffer
+    // that grows a slot at a time still retires O(log n) blocks
+    void grow(int capacity)
+    {
+        capacity = std::max(capacity, 2 * block->capacity);
+        Block* b = new Block();
+        b->points = new Vrui::Point[capacity];
+        b->capacity = capacity;
+        std::copy(block->points, block->points + count, b->points);
+
+        retired.push_back(block);
+        block = b;
+    }
+
+public:
+    PositionBuffer()
+        : count(0),
+          sequence(0),
+          generation(0)
+    {
+        block = new Block();
+        block->points = new Vrui::Point[1];
+        block->capacity = 1;
+    }
+
+    ~PositionBuffer()
+    {
+        retired.push_back(block);
+
+        foreach(Block* b, retired)
+        {
+            delete[] b->points;
+            delete b;
+        }
+    }
+
+    /*
+     * writers
+     */
+    void beginWrite()
+    {
+        sequence++;
+        __sync_synchronize();
+    }
+
+    void endWrite()
+    {
+        __sync_synchronize();
+        sequence++;
+    }
+
+    // also how writers read, since they can't race each other
+    Vrui::Point& operator[](int slot)
+    {
+        return block->points[slot];
+    }
+
+    const Vrui::Point& operator[](int slot) const
+    {
+        return block->points[slot];
+    }
+
+    void assign(const std::vector<Vrui::Point>& positions)
+    {
+        reserve(positions.size());
+        std::copy(positions.begin(), positions.end(), block->points);
+        count = positions.size();
+        generation++;
+    }
+
+    void clear()
+    {
+        count = 0;
+        generation++;
+    }
+
+    void eraseSlot(int slot)
+    {
+        block->points[slot] = block->points[count - 1];
+        count--;
+        generation++;
+    }
+
+    void push_back(const Vrui::Point& position)
+    {
+        if(count == block->capacity)
+        {
+            grow(count + 1);
+        }
+
+        block->points[count] = position;
+        count++;
+        generation++;
+    }
+
+    void reserve(int capacity)
+    {
+        if(capacity > block->capacity)
+        {
+            grow(capacity);
+        }
+    }
+
+    /*
+     * readers
+     */
+
+    // a consistent copy of every position, returns the generation it came from
+    const unsigned int read(std::vector<Vrui::Point>& positions) const
+    {
+        while(true)
+        {
+            unsigned int start = sequence;
+            __sync_synchronize();
+
+            if((start & 1) == 0)
+            {
+                const Block* b = block;
+                unsigned int g = generation;
+                positions.assign(b->points, b->points + std::min(count, b->capacity));
+
+                __sync_synchronize();
+                if(sequence == start) return g;
+            }
+
+            sched_yield();
+        }
+    }
+
+    const Vrui::Point get(int slot) const
+    {
+        while(true)
+        {
+            unsigned int start = sequence;
+            __sync_synchronize();
+
+            if((start & 1) == 0)
+            {
+                const Block* b = block;
+                Vrui::Point position = slot >= 0 && slot < std::min(count, b->capacity) ? b->points[slot] : Vrui::Point::origin;
+
+                __sync_synchronize();
+                if(sequence == start) return position;
+            }
+
+            sched_yield();
+        }
+    }
+
+    const unsigned int getGeneration() const
+    {
+        return generation;
+    }
+
+    const int size() const
+    {
+        return count;
+    }
+};
+
+#endif
@@ -44,6 +44,7 @@
 #include <FTGL/ftgl.h>
 
 // syscalls
+#include <pthread.h>
 #include <sys/wait.h>
 
 // glu
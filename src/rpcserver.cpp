@@ -38,18 +38,29 @@ void* RpcServer::run()
     r.addMethod("delete_edge", new DeleteEdge(app));
     r.addMethod("delete_node", new DeleteNode(app));
     r.addMethod("draw", new Draw(app));
+    r.addMethod("find_nodes", new FindNodes(app));
+    r.addMethod("find_nodes_in_range", new FindNodesInRange(app));
+    r.addMethod("get_edges", new GetEdges(app));
+    r.addMethod("get_node_positions", new GetNodePositions(app));
     r.addMethod("layout", new Layout(app));
+    r.addMethod("layout_is_stopped", new LayoutIsStopped(app));
     r.addMethod("add_edge", new AddEdge(app));
     r.addMethod("add_node", new AddNode(app));
     r.addMethod("add_node_at", new AddNodeAt(app));
+    r.addMethod("add_nodes", new AddNodes(app));
+    r.addMethod("add_edges", new AddEdges(app));
+    r.addMethod("add_node_attribute", new AddNodeAttribute(app));
     r.addMethod("open_file", new OpenFile(app));
     r.addMethod("randomize_positions", new RandomizePositions(app));
     r.addMethod("resume_layout", new ResumeLayout(app));
     r.addMethod("set_callback", new SetCallback(app, this));
+    r.addMethod("set_edge_attribute", new SetEdgeAttribute(app));
     r.addMethod("set_edge_color", new SetEdgeColor(app));
     r.addMethod("set_edge_label", new SetEdgeLabel(app));
     r.addMethod("set_edge_weight", new SetEdgeWeight(app));
     r.addMethod("set_layout_type", new SetLayoutType(app));
+    r.addMethod("set_layout_threads", new SetLayoutThreads(app));
+    r.addMethod("set_layout_tolerance", new SetLayoutTolerance(app));
     r.addMethod("set_node_attribute", new SetNodeAttribute(app));
     r.addMethod("set_node_color", new SetNodeColor(app));
     r.addMethod("set_node_label", new SetNodeLabel(app));
@@ -57,6 +68,8 @@ void* RpcServer::run()
     r.addMethod("set_node_type", new SetNodeType(app));
     r.addMethod("set_node_image_path", new SetNodeImagePath(app));
     r.addMethod("set_node_image_scale", new SetNodeImageScale(app));    
+    r.addMethod("set_opening_angle", new SetOpeningAngle(app));
+    r.addMethod("set_repulsion", new SetRepulsion(app));
     r.addMethod("set_status", new SetStatus(app));
     r.addMethod("set_texture_node_mode", new SetTextureNodeMode(app));
     r.addMethod("start_layout", new StartLayout(app));
@@ -21,12 +21,18 @@
 
 #include <graph.hpp>
 #include <mycelia.hpp>
+#include <layout/arflayout.hpp>
+#include <layout/frlayout.hpp>
+#include <layout/incrementallayout.hpp>
+#include <layout/multilevellayout.hpp>
 
 #include <xmlrpc-c/base.hpp>
 #include <xmlrpc-c/client_simple.hpp>
 #include <xmlrpc-c/registry.hpp>
 #include <xmlrpc-c/server_abyss.hpp>
 
+#define MAX_ADD_NODES 10000000 // per add_nodes call
+
 class RpcServer
 {
 private:
@@ -45,6 +51,25 @@ public:
     void setCallback(const std::string&, const std::string&);
 };
 
+// true if value is an int, double or boolean, which is then stored in number
+inline const bool getNumber(const xmlrpc_c::value& value, double& number)
+{
+    switch(value.type())
+    {
+    case xmlrpc_c::value::TYPE_INT:
+        number = (int)xmlrpc_c::value_int(value);
+        return true;
+    case xmlrpc_c::value::TYPE_DOUBLE:
+        number = xmlrpc_c::value_double(value);
+        return true;
+    case xmlrpc_c::value::TYPE_BOOLEAN:
+        number = (bool)xmlrpc_c::value_boolean(value);
+        return true;
+    default:
+        return false;
+    }
+}
+
 class AddEdge : public xmlrpc_c::method
 {
     Mycelia* app;
@@ -100,6 +125,110 @@ public:
     }
 };
 
+// adds count nodes in one batch, returns their ids, or -1 if count is
+// negative or over MAX_ADD_NODES
+class AddNodes : public xmlrpc_c::method
+{
+    Mycelia* app;
+
+public:
+    AddNodes(Mycelia* app) : app(app) {}
+
+    void execute(const xmlrpc_c::paramList& params, xmlrpc_c::value* retval)
+    {
+        int count = params.getInt(0);
+        params.verifyEnd(1);
+
+        if(count < 0 || count > MAX_ADD_NODES)
+        {
+            *retval = xmlrpc_c::value_int(-1);
+            return;
+        }
+
+        std::vector<xmlrpc_c::value> nodes;
+        app->g->beginBatch(count);
+
+        for(int i = 0; i < count; i++)
+        {
+            nodes.push_back(xmlrpc_c::value_int(app->g->addNode()));
+        }
+
+        app->g->commit();
+
+        *retval = xmlrpc_c::value_array(nodes);
+    }
+};
+
+// adds an array of [source, target] pairs in one batch, returns their ids
+class AddEdges : public xmlrpc_c::method
+{
+    Mycelia* app;
+
+public:
+    AddEdges(Mycelia* app) : app(app) {}
+
+    void execute(const xmlrpc_c::paramList& params, xmlrpc_c::value* retval)
+    {
+        std::vector<xmlrpc_c::value> pairs = params.getArray(0);
+        params.verifyEnd(1);
+
+        // converted before the batch, which holds the graph's lock until
+        // commit(), so a malformed pair throws without leaving it held
+        std::vector<std::pair<int, int> > endpoints;
+
+        for(int i = 0; i < (int)pairs.size(); i++)
+        {
+            std::vector<xmlrpc_c::value> pair = xmlrpc_c::value_array(pairs[i]).vectorValueValue();
+            int source = xmlrpc_c::value_int(pair.at(0));
+            int target = xmlrpc_c::value_int(pair.at(1));
+
+            endpoints.push_back(std::pair<int, int>(source, target));
+        }
+
+        std::vector<xmlrpc_c::value> edges;
+        app->g->beginBatch(0, endpoints.size());
+
+        for(int i = 0; i < (int)endpoints.size(); i++)
+        {
+            edges.push_back(xmlrpc_c::value_int(app->g->addEdge(endpoints[i].first, endpoints[i].second)));
+        }
+
+        app->g->commit();
+
+        *retval = xmlrpc_c::value_array(edges);
+    }
+};
+
+// declares a node attribute as "int", "float" or "string", and whether to
+// index it for find_nodes
+class AddNodeAttribute : public xmlrpc_c::method
+{
+    Mycelia* app;
+
+public:
+    AddNodeAttribute(Mycelia* app) : app(app) {}
+
+    void execute(const xmlrpc_c::paramList& params, xmlrpc_c::value* retval)
+    {
+        std::string key = params.getString(0);
+        std::string type = params.getString(1);
+        bool indexed = params.getBoolean(2);
+        params.verifyEnd(3);
+
+        int indexes = indexed ? AttributeColumn::INDEX_HASH | AttributeColumn::INDEX_SORTED : AttributeColumn::INDEX_NONE;
+
+        if(type == "int") app->g->addNodeAttribute(key, AttributeColumn::INT, indexes);
+        else if(type == "float") app->g->addNodeAttribute(key, AttributeColumn::FLOAT, indexes);
+        else if(type == "string") app->g->addNodeAttribute(key, AttributeColumn::STRING, indexes);
+        else
+        {
+            *retval = xmlrpc_c::value_int(-1);
+            return;
+        }
+
+        *retval = xmlrpc_c::value_int(0);
+    }
+};
 
 class Center : public xmlrpc_c::method
 {
@@ -209,6 +338,142 @@ public:
     }
 };
 
+// returns the ids of the nodes whose attribute equals the given value
+class FindNodes : public xmlrpc_c::method
+{
+    Mycelia* app;
+
+public:
+    FindNodes(Mycelia* app) : app(app) {}
+
+    void execute(const xmlrpc_c::paramList& params, xmlrpc_c::value* retval)
+    {
+        std::string key = params.getString(0);
+        std::string value;
+        double number;
+
+        if(getNumber(params[1], number))
+        {
+            std::ostringstream out;
+            out.precision(17);
+            out << number;
+            value = out.str();
+        }
+        else
+        {
+            value = params.getString(1);
+        }
+
+        params.verifyEnd(2);
+
+        std::vector<int> found;
+        app->g->findNodes(key, value, found);
+
+        std::vector<xmlrpc_c::value> nodes;
+
+        for(int i = 0; i < (int)found.size(); i++)
+        {
+            nodes.push_back(xmlrpc_c::value_int(found[i]));
+        }
+
+        *retval = xmlrpc_c::value_array(nodes);
+    }
+};
+
+// returns the ids of the nodes whose numeric attribute is in [min, max]
+class FindNodesInRange : public xmlrpc_c::method
+{
+    Mycelia* app;
+
+public:
+    FindNodesInRange(Mycelia* app) : app(app) {}
+
+    void execute(const xmlrpc_c::paramList& params, xmlrpc_c::value* retval)
+    {
+        std::string key = params.getString(0);
+        double min = params.getDouble(1);
+        double max = params.getDouble(2);
+        params.verifyEnd(3);
+
+        std::vector<int> found;
+        app->g->findNodes(key, min, max, found);
+
+        std::vector<xmlrpc_c::value> nodes;
+
+        for(int i = 0; i < (int)found.size(); i++)
+        {
+            nodes.push_back(xmlrpc_c::value_int(found[i]));
+        }
+
+        *retval = xmlrpc_c::value_array(nodes);
+    }
+};
+
+// returns [id, source, target] for every edge
+class GetEdges : public xmlrpc_c::method
+{
+    Mycelia* app;
+
+public:
+    GetEdges(Mycelia* app) : app(app) {}
+
+    void execute(const xmlrpc_c::paramList& params, xmlrpc_c::value* retval)
+    {
+        params.verifyEnd(0);
+
+        std::vector<xmlrpc_c::value> edges;
+        app->g->lock();
+
+        foreach(int edge, app->g->getEdges())
+        {
+            const Edge& e = app->g->getEdge(edge);
+
+            std::vector<xmlrpc_c::value> entry;
+            entry.push_back(xmlrpc_c::value_int(edge));
+            entry.push_back(xmlrpc_c::value_int(e.source));
+            entry.push_back(xmlrpc_c::value_int(e.target));
+            edges.push_back(xmlrpc_c::value_array(entry));
+        }
+
+        app->g->unlock();
+
+        *retval = xmlrpc_c::value_array(edges);
+    }
+};
+
+// returns [id, x, y, z] for every node
+class GetNodePositions : public xmlrpc_c::method
+{
+    Mycelia* app;
+
+public:
+    GetNodePositions(Mycelia* app) : app(app) {}
+
+    void execute(const xmlrpc_c::paramList& params, xmlrpc_c::value* retval)
+    {
+        params.verifyEnd(0);
+
+        std::vector<xmlrpc_c::value> nodes;
+        app->g->lock();
+
+        foreach(int node, app->g->getNodes())
+        {
+            Vrui::Point p = app->g->getNodePosition(node);
+
+            std::vector<xmlrpc_c::value> entry;
+            entry.push_back(xmlrpc_c::value_int(node));
+            entry.push_back(xmlrpc_c::value_double(p[0]));
+            entry.push_back(xmlrpc_c::value_double(p[1]));
+            entry.push_back(xmlrpc_c::value_double(p[2]));
+            nodes.push_back(xmlrpc_c::value_array(entry));
+        }
+
+        app->g->unlock();
+
+        *retval = xmlrpc_c::value_array(nodes);
+    }
+};
+
 class Layout : public xmlrpc_c::method
 {
     Mycelia* app;
@@ -226,6 +491,21 @@ public:
     }
 };
 
+class LayoutIsStopped : public xmlrpc_c::method
+{
+    Mycelia* app;
+
+public:
+    LayoutIsStopped(Mycelia* app) : app(app) {}
+
+    void execute(const xmlrpc_c::paramList& params, xmlrpc_c::value* retval)
+    {
+        params.verifyEnd(0);
+
+        *retval = xmlrpc_c::value_boolean(app->layoutIsStopped());
+    }
+};
+
 class OpenFile : public xmlrpc_c::method
 {
     Mycelia* app;
@@ -294,6 +574,35 @@ public:
     }
 };
 
+// the value can be a string or a number
+class SetEdgeAttribute : public xmlrpc_c::method
+{
+    Mycelia* app;
+
+public:
+    SetEdgeAttribute(Mycelia* app) : app(app) {}
+
+    void execute(const xmlrpc_c::paramList& params, xmlrpc_c::value* retval)
+    {
+        int edge = params.getInt(0);
+        std::string key = params.getString(1);
+        double number;
+
+        if(getNumber(params[2], number))
+        {
+            app->g->setEdgeAttribute(edge, key, number);
+        }
+        else
+        {
+            app->g->setEdgeAttribute(edge, key, params.getString(2));
+        }
+
+        params.verifyEnd(3);
+
+        *retval = xmlrpc_c::value_int(0);
+    }
+};
+
 class SetEdgeColor : public xmlrpc_c::method
 {
     Mycelia* app;
@@ -372,6 +681,91 @@ public:
     }
 };
 
+// the number of threads every layout computes forces on
+class SetLayoutThreads : public xmlrpc_c::method
+{
+    Mycelia* app;
+
+public:
+    SetLayoutThreads(Mycelia* app) : app(app) {}
+
+    void execute(const xmlrpc_c::paramList& params, xmlrpc_c::value* retval)
+    {
+        int threads = params.getInt(0);
+        params.verifyEnd(1);
+
+        app->getStaticLayout()->setThreadCount(threads);
+        app->getDynamicLayout()->setThreadCount(threads);
+        app->getMultilevelLayout()->setThreadCount(threads);
+        app->getIncrementalLayout()->setThreadCount(threads);
+
+        *retval = xmlrpc_c::value_int(0);
+    }
+};
+
+// how little the static layout moves nodes, in units of its spring length,
+// before it stops; 0 runs it to its iteration limit
+class SetLayoutTolerance : public xmlrpc_c::method
+{
+    Mycelia* app;
+
+public:
+    SetLayoutTolerance(Mycelia* app) : app(app) {}
+
+    void execute(const xmlrpc_c::paramList& params, xmlrpc_c::value* retval)
+    {
+        double tolerance = params.getDouble(0);
+        params.verifyEnd(1);
+
+        app->getStaticLayout()->setTolerance(tolerance);
+
+        *retval = xmlrpc_c::value_int(0);
+    }
+};
+
+class SetOpeningAngle : public xmlrpc_c::method
+{
+    Mycelia* app;
+
+public:
+    SetOpeningAngle(Mycelia* app) : app(app) {}
+
+    void execute(const xmlrpc_c::paramList& params, xmlrpc_c::value* retval)
+    {
+        double openingAngle = params.getDouble(0);
+        params.verifyEnd(1);
+
+        app->getStaticLayout()->setOpeningAngle(openingAngle);
+
+        *retval = xmlrpc_c::value_int(0);
+    }
+};
+
+// 0 for exact repulsion, 1 for Barnes-Hut, 2 for a grid with a cutoff;
+// returns -1 for anything else
+class SetRepulsion : public xmlrpc_c::method
+{
+    Mycelia* app;
+
+public:
+    SetRepulsion(Mycelia* app) : app(app) {}
+
+    void execute(const xmlrpc_c::paramList& params, xmlrpc_c::value* retval)
+    {
+        int repulsion = params.getInt(0);
+        params.verifyEnd(1);
+
+        if(!app->getStaticLayout()->setRepulsion(repulsion))
+        {
+            *retval = xmlrpc_c::value_int(-1);
+            return;
+        }
+
+        *retval = xmlrpc_c::value_int(0);
+    }
+};
+
+// the value can be a string or a number
 class SetNodeAttribute : public xmlrpc_c::method
 {
     Mycelia* app;
@@ -383,10 +777,18 @@ public:
     {
         int node = params.getInt(0);
         std::string key = params.getString(1);
-        std::string val = params.getString(2);
-        params.verifyEnd(3);
+        double number;
+
+        if(getNumber(params[2], number))
+        {
+            app->g->setNodeAttribute(node, key, number);
+        }
+        else
+        {
+            app->g->setNodeAttribute(node, key, params.getString(2));
+        }
 
-        app->g->setNodeAttribute(node, key, val);
+        params.verifyEnd(3);
 
         *retval = xmlrpc_c::value_int(0);
     }
@@ -465,7 +867,7 @@ public:
         std::string type = params.getString(1);
         params.verifyEnd(2);
 
-        app->g->setNodeType(node, type);
+        app->g->setNodeType(node, type == "image" ? NODE_IMAGE : NODE_SHAPE);
 
         *retval = xmlrpc_c::value_int(0);
     }
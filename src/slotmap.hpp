@@ -0,0 +1,115 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SLOTMAP_HPP
+#define __SLOTMAP_HPP
+
+#include <algorithm>
+#include <vector>
+
+/*
+ * Maps stable external ids onto dense slots 0..size()-1.
+ *
+ * Ids are handed out monotonically and never reused, so an id that has been
+ * erased stays invalid forever and can never alias a newer element. Erasing
+ * moves the last slot into the hole, which keeps every slot-indexed array
+ * owned by the caller contiguous. Callers mirror that move with eraseSlot().
+ */
+class SlotMap
+{
+private:
+    std::vector<int> ids;   // slot -> id
+    std::vector<int> slots; // id -> slot, or -1 once erased
+
+public:
+    void clear()
+    {
+        ids.clear();
+        slots.clear();
+    }
+
+    void reserve(int count)
+    {
+        ids.reserve(count);
+        slots.reserve(count);
+    }
+
+    // returns the new id, whose slot is size() - 1
+    const int insert()
+    {
+        int id = slots.size();
+        slots.push_back(ids.size());
+        ids.push_back(id);
+        return id;
+    }
+
+    // returns the slot that was vacated and refilled from the last slot
+    const int erase(int id)
+    {
+        int slot = slots[id];
+        int last = ids.size() - 1;
+
+        ids[slot] = ids[last];
+        slots[ids[slot]] = slot;
+        ids.pop_back();
+        slots[id] = -1;
+
+        return slot;
+    }
+
+    const bool contains(int id) const
+    {
+        return id >= 0 && id < (int)slots.size() && slots[id] != -1;
+    }
+
+    const int getSlot(int id) const
+    {
+        return contains(id) ? slots[id] : -1;
+    }
+
+    const int getId(int slot) const
+    {
+        return ids[slot];
+    }
+
+    const std::vector<int>& getIds() const
+    {
+        return ids;
+    }
+
+    // one past the largest id handed out so far
+    const int getIdBound() const
+    {
+        return slots.size();
+    }
+
+    const int size() const
+    {
+        return ids.size();
+    }
+};
+
+// Mirrors SlotMap::erase() on a slot-indexed array.
+template <class T>
+inline void eraseSlot(std::vector<T>& v, int slot)
+{
+    std::swap(v[slot], v.back());
+    v.pop_back();
+}
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stringtable.hpp>
+
+using namespace std;
+
+StringTable::StringTable()
+{
+    clear();
+}
+
+const string& StringTable::get(int handle) const
+{
+    return strings[handle];
+}
+
+// makes handles this table's own, rebuilding them if follow() dropped them
+void StringTable::editHandles()
+{
+    if(!handles)
+    {
+        handles.reset(new Handles());
+        freeHandles.clear();
+
+        for(int handle = 0; handle < strings.size(); handle++)
+        {
+            if(handle > 0 && references[handle] == 0)
+            {
+                freeHandles.push_back(handle);
+            }
+            else
+            {
+                (*handles)[strings[handle]] = handle;
+            }
+        }
+    }
+    else if(!handles.unique())
+    {
+        handles.reset(new Handles(*handles));
+    }
+}
+
+// returns the handle of s, adding it if it's new; release() it when done
+const int StringTable::intern(const string& s)
+{
+    if(s.empty()) return 0;
+
+    if(!handles)
+    {
+        editHandles();
+    }
+
+    Handles::iterator i = handles->find(s);
+
+    if(i != handles->end())
+    {
+        references.edit(i->second)++;
+        return i->second;
+    }
+
+    editHandles();
+
+    int handle;
+
+    if(freeHandles.empty())
+    {
+        handle = strings.size();
+        strings.push_back(s);
+        references.push_back(1);
+    }
+    else
+    {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+        strings.edit(handle) = s;
+        references.edit(handle) = 1;
+    }
+
+    (*handles)[s] = handle;
+    return handle;
+}
+
+void StringTable::release(int handle)
+{
+    if(handle <= 0 || handle >= strings.size() || references[handle] == 0)
+    {
+        return;
+    }
+
+    if(--references.edit(handle) == 0)
+    {
+        editHandles();
+        handles->erase(strings[handle]);
+        strings.edit(handle).clear();
+        freeHandles.push_back(handle);
+    }
+}
+
+const int StringTable::size() const
+{
+    return strings.size() - freeHandles.size();
+}
+
+void StringTable::clear()
+{
+    strings.clear();
+    strings.push_back("");
+    references.clear();
+    references.push_back(0);
+    freeHandles.clear();
+    handles.reset(new Handles());
+    (*handles)[""] = 0;
+}
+
+void StringTable::follow(const StringTable& t)
+{
+    strings = t.strings;
+    references = t.references;
+    freeHandles.clear();
+    handles.reset();
+}
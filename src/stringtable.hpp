@@ -0,0 +1,62 @@
+/*
+ * Mycelia immersive 3d network visualization tool.
+ * Copyright (C) 2008-2010 Sean Whalen.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __STRINGTABLE_HPP
+#define __STRINGTABLE_HPP
+
+#include <cowvector.hpp>
+#include <string>
+#include <vector>
+#include <tr1/unordered_map>
+#include <boost/shared_ptr.hpp>
+
+/*
+ * Interns strings as small int handles, so records store an int and equal
+ * strings are kept once. Handle 0 is the empty string. Handles are
+ * reference counted: every intern() is paired with a release(), and a handle
+ * nothing uses any more is recycled for the next new string.
+ *
+ * The strings and counts are CowVectors, so copies share them chunk by
+ * chunk. The string -> handle map is shared copy-on-write too; follow()
+ * copies just the vectors, for snapshots that only ever read handles, so the
+ * table they came from never has to clone its map.
+ */
+class StringTable
+{
+private:
+    typedef std::tr1::unordered_map<std::string, int> Handles;
+
+    CowVector<std::string> strings;
+    CowVector<int> references;
+    std::vector<int> freeHandles;
+    boost::shared_ptr<Handles> handles;
+
+    void editHandles();
+
+public:
+    StringTable();
+
+    const std::string& get(int) const;
+    const int intern(const std::string&);
+    void release(int);
+    const int size() const;
+    void clear();
+    void follow(const StringTable&);
+};
+
+#endif
@@ -115,7 +115,7 @@ void GraphBuilder::display(GLContextData& contextData) const
     {
         bool drawArrow = true;
         bool bidirectional = false;
-        const GLMaterial* material = factory->application->g->getEdgeMaterialFromId(MATERIAL_EDGE_DEFAULT);
+        const GLMaterial* material = factory->application->gCopy->getEdgeMaterialFromId(MATERIAL_EDGE_DEFAULT);
 
         MyceliaDataItem* dataItem = contextData.retrieveDataItem<MyceliaDataItem>(this);
         glPushMatrix();